@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Bakes a signed distance field (SDF) of the collidable geometry into a 2D texture (see
+    CollidablePolygonSdf.comp).  The geometry is loaded from the same Blender3D .obj file as
+    the CollidablePolygonSsbo.
+
+    Baking checks every texel against every polygon, so it is split between as many CPU threads
+    as are available.  The result is saved next to the .obj file (same name + ".sdf") and is
+    loaded from there on the next run unless the geometry or the field's size has changed.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class CollidablePolygonSdf
+{
+public:
+    CollidablePolygonSdf(const std::string &blenderMeshFilePath);
+    ~CollidablePolygonSdf();
+    using SharedPtr = std::shared_ptr<CollidablePolygonSdf>;
+    using SharedConstPtr = std::shared_ptr<const CollidablePolygonSdf>;
+
+    void BindToTextureUnit() const;
+
+private:
+    unsigned int _textureId;
+};
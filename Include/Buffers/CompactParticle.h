@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ThirdParty/glm/vec2.hpp"
+#include "Include/Buffers/Particle.h"
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    The 24-byte version of Particle for PARTICLE_LAYOUT_COMPACT (see ParticleLayout.comp).  The 
+    Z and W lanes are dropped, the velocity is two half floats, and the type, nearby count, 
+    "is active" flag, and sleep counter are one byte apiece.
+
+    Only used on the CPU side to make the initial upload.  Everything after that goes through 
+    ParticleBuffer.comp.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+struct CompactParticle
+{
+    CompactParticle();
+    CompactParticle(const Particle &p);
+
+    glm::vec2 _currPos;
+    glm::vec2 _prevPos;
+
+    // glm::packHalf2x16(...)
+    unsigned int _packedVel;
+
+    // one byte apiece (see the PACKED_PARTICLE_..._SHIFT defines in ParticleLayout.comp)
+    unsigned int _packedFlags;
+};
+
+// also used by the structure of arrays layout's flags
+unsigned int PackParticleFlags(const Particle &p);
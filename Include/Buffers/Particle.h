@@ -23,7 +23,8 @@ struct Particle
     Particle() :
         _particleTypeIndex(ParticleProperties::ParticleType::NO_PARTICLE_TYPE),
         _numNearbyParticles(0),
-        _isActive(0)
+        _isActive(0),
+        _sleepCounter(0)
     {
     }
 
@@ -40,6 +41,7 @@ struct Particle
     // if off (0), then it won't be updated
     int _isActive;
 
-    // any necessary padding out to 16 bytes to match the GPU's version
-    int _padding[1];
+    // how many frames in a row it has been nearly still (see ParticleSleep.comp)
+    // Note: This used to be padding out to 16 bytes, and now it fills that space exactly.
+    int _sleepCounter;
 };
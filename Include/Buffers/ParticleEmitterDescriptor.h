@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ThirdParty/glm/vec4.hpp"
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Everything that the emission shader needs to know about one emitter, whether it is a point 
+    or a bar.  The compute shader has no concept of inheritance, so the emitters are flattened 
+    into this before they are uploaded (see ParticleEmitterSsbo).  Must match the value type 
+    and order in ParticleEmitterBuffer.comp.
+
+    Point emitters only use _p1 (the center).  Bar emitters use all three vectors.  Either one 
+    gives every particle that it emits the same _particleTypeIndex.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+struct ParticleEmitterDescriptor
+{
+    // must match the PARTICLE_EMITTER_TYPE_* values in ParticleEmitterBuffer.comp
+    enum EmitterType
+    {
+        POINT = 0,
+        BAR = 1
+    };
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        Sets initial values.  The glm structures have their own zero initialization.
+    Parameters: None
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    -------------------------------------------------------------------------------------------*/
+    ParticleEmitterDescriptor() :
+        _minVel(0.0f),
+        _maxVel(0.0f),
+        _emitterType(EmitterType::POINT),
+        _maxEmitCount(0),
+        _emitStart(0),
+        _emitCount(0),
+        _particleTypeIndex(0),
+        _padding(0)
+    {
+    }
+
+    glm::vec4 _p1;
+    glm::vec4 _p2;
+    glm::vec4 _emitDir;
+    float _minVel;
+    float _maxVel;
+    unsigned int _emitterType;
+
+    // the emitter's quota for this frame
+    unsigned int _maxEmitCount;
+
+    // filled in on the GPU by PrepareParticleEmission.comp
+    unsigned int _emitStart;
+    unsigned int _emitCount;
+
+    // one of ParticleProperties::ParticleType
+    int _particleTypeIndex;
+
+    // 3x vec4s are 48 bytes, +7x 4-byte items is 76, and std430 pads the struct out to a 
+    // multiple of 16 (the vec4 alignment)
+    unsigned int _padding;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ThirdParty/glm/vec4.hpp"
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    One entry in the force field table that ParticleUpdate.comp applies to every particle (see
+    ParticleForceFields.comp for what each type does).  Must match the value type and order in
+    ParticleForceFieldBuffer.comp.
+
+    Use the static functions to make one.  They fill in only what that type of field uses.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+struct ParticleForceField
+{
+    // must match the PARTICLE_FORCE_FIELD_* values in ParticleForceFields.comp
+    enum ForceFieldType
+    {
+        NONE = 0,
+        GRAVITY = 1,
+        DRAG = 2,
+        RADIAL = 3
+    };
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        Sets initial values.  The glm structures have their own zero initialization.
+    Parameters: None
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    -------------------------------------------------------------------------------------------*/
+    ParticleForceField() :
+        _type(ForceFieldType::NONE),
+        _strength(0.0f),
+        _quadraticStrength(0.0f),
+        _radius(0.0f)
+    {
+    }
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        The same acceleration everywhere.
+    Parameters:
+        acceleration    Self-explanatory.
+    Returns:
+        A new force field.
+    Creator:    John Cox, 10/2017
+    -------------------------------------------------------------------------------------------*/
+    static ParticleForceField Gravity(const glm::vec4 &acceleration)
+    {
+        ParticleForceField f;
+        f._type = ForceFieldType::GRAVITY;
+        f._vector = acceleration;
+        f._vector.w = 0.0f;
+        return f;
+    }
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        Slows particles down by (linear + quadratic * speed) * velocity.
+    Parameters:
+        linear      Self-explanatory.
+        quadratic   Self-explanatory.
+    Returns:
+        A new force field.
+    Creator:    John Cox, 10/2017
+    -------------------------------------------------------------------------------------------*/
+    static ParticleForceField Drag(float linear, float quadratic)
+    {
+        ParticleForceField f;
+        f._type = ForceFieldType::DRAG;
+        f._strength = linear;
+        f._quadraticStrength = quadratic;
+        return f;
+    }
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        Pulls particles toward the center.  The pull is "strength" at the center and fades to 0
+        at "radius".
+    Parameters:
+        center      Self-explanatory.
+        strength    Negative pushes particles away (a repulsor).
+        radius      Particles farther than this are not affected.
+    Returns:
+        A new force field.
+    Creator:    John Cox, 10/2017
+    -------------------------------------------------------------------------------------------*/
+    static ParticleForceField Radial(const glm::vec4 &center, float strength, float radius)
+    {
+        ParticleForceField f;
+        f._type = ForceFieldType::RADIAL;
+        f._vector = center;
+        f._vector.w = 0.0f;
+        f._strength = strength;
+        f._radius = radius;
+        return f;
+    }
+
+    // gravity's acceleration or the radial field's center
+    glm::vec4 _vector;
+    int _type;
+    float _strength;
+    float _quadraticStrength;
+    float _radius;
+
+    // 1x vec4 is 16 bytes, +4x 4-byte items is 32, which is already a multiple of 16, so
+    // std140 doesn't pad it
+};
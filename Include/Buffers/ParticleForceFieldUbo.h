@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Include/Buffers/UboBase.h"
+#include "Include/Buffers/ParticleForceField.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    This generates and maintains the table of force fields (gravity, drag, attractors, etc.)
+    that ParticleUpdate.comp applies to every particle.  See ParticleForceFieldBuffer.comp.
+
+    Like the ParticlePropertiesUbo, the table is small and every thread reads all of it, which
+    is what the GPU's constant cache is for.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleForceFieldUbo : public UboBase
+{
+public:
+    ParticleForceFieldUbo();
+    ~ParticleForceFieldUbo() = default;
+    using SharedPtr = std::shared_ptr<ParticleForceFieldUbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticleForceFieldUbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+
+    bool AddForceField(const ParticleForceField &forceField);
+    unsigned int NumForceFields() const;
+
+private:
+    unsigned int _numForceFields;
+};
@@ -13,8 +13,9 @@ struct ParticleProperties
 {
     /*--------------------------------------------------------------------------------------------
     Description:
-        At this time (5/27/2017) there is only one type of particle.  Eventually (and hopefully), 
-        this particle collision demo will handle more than 1, but for now there is only one.
+        At this time (10/2017) there are two types of particles: GENERIC, and HEAVY, which is 
+        bigger, heavier, and less bouncy so that the mixed-material collision math gets 
+        exercised.  Each emitter decides which type it emits.
 
         Note: This is a weakly-typed enum because 
         (1) it will be used as an index
@@ -28,18 +29,21 @@ struct ParticleProperties
     enum ParticleType
     {
         // anything that auto-initializes to 0 will be a dud particle
-        // Note: Yes, that does mean that there will be a slot in the ParticlePropertiesSsbo 
+        // Note: Yes, that does mean that there will be a slot in the ParticlePropertiesUbo
         // that has 0 mass and 0 collision radius.  This is intended.  The mass of 0 could cause 
         // a division to blow up, but if a particle was created with no type, then I want it to 
         // blow up so that I can fix it.
         NO_PARTICLE_TYPE = 0,
         GENERIC,
+        HEAVY,
         NUM_PARTICLE_PROPERTIES,
     };
 
     ParticleProperties() :
         _mass(0.0f),
-        _collisionRadius(0.0f)
+        _collisionRadius(0.0f),
+        _restitution(0.0f),
+        _friction(0.0f)
     {
 
     }
@@ -48,4 +52,10 @@ struct ParticleProperties
     // Ex: 1/(0.05 + 0.05) != (1/0.05) + (1/0.05).
     float _mass;
     float _collisionRadius;
+
+    // how much of the approach speed is kept in a bounce (0 - 1)
+    float _restitution;
+
+    // Coulomb friction coefficient; how much the bounce can slow down sliding
+    float _friction;
 };
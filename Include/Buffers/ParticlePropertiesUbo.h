@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Include/Buffers/UboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    This generates and maintains the table of ParticleProperties structures (one for each 
+    particle type) in a uniform buffer.
+
+    This used to be an SSBO, but the table is small, never changes, and is read on every 
+    particle-particle and particle-polygon check.  Uniform buffers are read through the GPU's 
+    constant cache, which is meant for exactly that.
+Creator:    John Cox, 5/2017
+------------------------------------------------------------------------------------------------*/
+class ParticlePropertiesUbo : public UboBase
+{
+public:
+    ParticlePropertiesUbo();
+    ~ParticlePropertiesUbo() = default;
+    using SharedPtr = std::shared_ptr<ParticlePropertiesUbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticlePropertiesUbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+
+    unsigned int NumProperties() const;
+    float MinCollisionRadius() const;
+
+private:
+    unsigned int _numProperties;
+    float _minCollisionRadius;
+};
+
@@ -35,6 +35,18 @@ Description:
 
     Also Also Note: I don't need to bother with multithread design because the OpenGL context 
     only runs one thread anyway.
+
+    Update (10/2017): Resetting the counter used to wait for the whole GPU queue to drain 
+    before writing a 0 through the persistent pointer, and reading it waited again.  That was 
+    two CPU stalls on every ParticleUpdate::Update(...).  Now there is a ring of counters that 
+    stay in video memory:
+    - ResetCounter() moves on to the next counter, clears it on the GPU with 
+      glClearBufferSubData(...), and binds it to ATOMIC_COUNTER_BUFFER_BINDING
+    - QueueCounterReadback() copies the counter on the GPU into a persistently mapped readback 
+      buffer and puts down a fence
+    - GetCounterValue() returns the newest counter whose fence has already signaled
+    Nothing waits.  The catch is that the value is a few calls stale (at most 
+    NUM_COUNTER_SLOTS), which is fine for an on-screen "active particles" count.
 Creator:    John Cox, 4/2017
 ------------------------------------------------------------------------------------------------*/
 class PersistentAtomicCounterBuffer
@@ -47,12 +59,23 @@ private:
 
 public:
     ~PersistentAtomicCounterBuffer();
-    static const PersistentAtomicCounterBuffer &GetInstance();
+    static PersistentAtomicCounterBuffer &GetInstance();
 
-    void ResetCounter() const;
-    unsigned int GetCounterValue() const;
+    void ResetCounter();
+    void QueueCounterReadback();
+    unsigned int GetCounterValue();
 
 private:
-    unsigned int _bufferId;
-    unsigned int *_bufferPtr;
+    // how many counters are in flight before one is reused
+    static const unsigned int NUM_COUNTER_SLOTS = 4;
+
+    unsigned int _counterBufferId;
+    unsigned int _readbackBufferId;
+    unsigned int *_readbackPtr;
+
+    // Note: GLsync is a pointer to an opaque struct, and I don't want to include the OpenGL 
+    // header here, so they are stored as void pointers.
+    void *_slotFences[NUM_COUNTER_SLOTS];
+    unsigned int _currentSlot;
+    unsigned int _latestValue;
 };
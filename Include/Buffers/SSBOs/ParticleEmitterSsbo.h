@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+#include "Include/Buffers/ParticleEmitterDescriptor.h"
+
+#include <vector>
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the SSBO that holds every particle emitter (see ParticleEmitterBuffer.comp).  
+    The emitters can be moved around at runtime, so they are uploaded again every frame.  The 
+    buffer grows to fit however many there are.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleEmitterSsbo : public SsboBase
+{
+public:
+    ParticleEmitterSsbo();
+    ~ParticleEmitterSsbo() = default;
+    using SharedPtr = std::shared_ptr<ParticleEmitterSsbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticleEmitterSsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+    void Upload(const std::vector<ParticleEmitterDescriptor> &emitters);
+
+private:
+    unsigned int _capacity;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the SSBO that holds the stack of inactive particle indices (see 
+    ParticleFreeListBuffer.comp).  The stack's header doubles as the indirect dispatch 
+    arguments for the emitters.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleFreeListSsbo : public SsboBase
+{
+public:
+    ParticleFreeListSsbo(unsigned int numParticles);
+    ~ParticleFreeListSsbo() = default;
+    using SharedPtr = std::shared_ptr<ParticleFreeListSsbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticleFreeListSsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+    static unsigned int IndirectDispatchOffsetBytes();
+};
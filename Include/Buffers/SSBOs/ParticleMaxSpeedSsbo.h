@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the SSBO that MeasureMaxParticleSpeed.comp reduces the fastest particle's speed 
+    into.  Used to choose how many sub-steps to take each frame (see SubStepping.comp).
+
+    The value is read back the same way as the PersistentAtomicCounterBuffer's counter: the GPU 
+    copies it into a ring of persistently mapped slots and puts down a fence after each copy, 
+    and the CPU takes the newest slot whose fence has signaled.  Nothing waits, but the value 
+    is usually a frame old.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleMaxSpeedSsbo : public SsboBase
+{
+public:
+    ParticleMaxSpeedSsbo();
+    ~ParticleMaxSpeedSsbo();
+    using SharedPtr = std::shared_ptr<ParticleMaxSpeedSsbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticleMaxSpeedSsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+    void Reset() const;
+    void QueueReadback();
+    float GetMaxSpeedInRadiiSqr();
+
+private:
+    // how many readbacks are in flight before one is reused
+    static const unsigned int NUM_READBACK_SLOTS = 4;
+
+    unsigned int _readbackBufferId;
+    float *_readbackPtr;
+
+    // Note: GLsync is a pointer to an opaque struct, and I don't want to include the OpenGL 
+    // header here, so they are stored as void pointers (like in PersistentAtomicCounterBuffer).
+    void *_slotFences[NUM_READBACK_SLOTS];
+    unsigned int _currentSlot;
+    float _latestMaxSpeedInRadiiSqr;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the pair of SSBOs that hold each particle's velocity from before
+    particle-particle collisions are resolved.  One is read while the other is written, and
+    Swap() trades their bindings (see ParticleCollisionVelocityBuffer.comp).
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleCollisionVelocitySsbo : public SsboBase
+{
+public:
+    ParticleCollisionVelocitySsbo(unsigned int numParticles);
+    ~ParticleCollisionVelocitySsbo();
+    using SharedPtr = std::shared_ptr<ParticleCollisionVelocitySsbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticleCollisionVelocitySsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+    unsigned int NumItems() const;
+
+    void Swap();
+
+private:
+    // _bufferId is always the one bound for reading
+    unsigned int _writeBufferId;
+    unsigned int _numItems;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the SSBO that holds each particle's list of contacts and its colour in the 
+    contact graph for the particle-particle contact solver (see ParticleContactSolver.comp).
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleContactSsbo : public SsboBase
+{
+public:
+    ParticleContactSsbo(unsigned int numParticles);
+    ~ParticleContactSsbo() = default;
+    using SharedPtr = std::shared_ptr<ParticleContactSsbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticleContactSsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+    unsigned int NumItems() const;
+
+private:
+    unsigned int _numItems;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the SSBO that records where each particle was when the particle BVH was last 
+    built, along with the largest squared distance that any particle has moved since then and 
+    the indirect dispatch arguments that skip the sorting and BVH generation when it is small 
+    enough (see NeighbourListSkin.comp and DecideNeighbourListRebuild.comp).
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleNeighbourListReferenceSsbo : public SsboBase
+{
+public:
+    ParticleNeighbourListReferenceSsbo(unsigned int numParticles);
+    ~ParticleNeighbourListReferenceSsbo() = default;
+    using SharedPtr = std::shared_ptr<ParticleNeighbourListReferenceSsbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticleNeighbourListReferenceSsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+    unsigned int NumItems() const;
+    void ReadRebuildCounts(unsigned int &numDecisions, unsigned int &numRebuilds) const;
+
+    static unsigned int RebuildDispatchOffsetBytes();
+    static unsigned int RebuildPrefixScanDispatchOffsetBytes();
+    static unsigned int RebuildSingleWorkGroupDispatchOffsetBytes();
+    static unsigned int PhysicalSortDispatchOffsetBytes();
+    static unsigned int IndexSortDispatchOffsetBytes();
+
+private:
+    unsigned int _numItems;
+};
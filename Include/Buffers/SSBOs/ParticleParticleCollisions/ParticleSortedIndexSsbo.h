@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the SSBO that holds the particles' Morton Code order when the index sort is on
+    (see ParticleIndexSort.comp and ParticleSortedIndexBuffer.comp).
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleSortedIndexSsbo : public SsboBase
+{
+public:
+    ParticleSortedIndexSsbo(unsigned int numParticles);
+    ~ParticleSortedIndexSsbo() = default;
+    using SharedPtr = std::shared_ptr<ParticleSortedIndexSsbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticleSortedIndexSsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+};
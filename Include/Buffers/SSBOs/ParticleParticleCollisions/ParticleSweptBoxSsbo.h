@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the SSBO that holds each particle's bounding box over its path this frame when
+    the particle update is fused with the Morton Code and bounding box generation (see
+    FusedParticleUpdate.comp and ParticleSweptBoxBuffer.comp).
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleSweptBoxSsbo : public SsboBase
+{
+public:
+    ParticleSweptBoxSsbo(unsigned int numParticles);
+    ~ParticleSweptBoxSsbo() = default;
+    using SharedPtr = std::shared_ptr<ParticleSweptBoxSsbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticleSweptBoxSsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+};
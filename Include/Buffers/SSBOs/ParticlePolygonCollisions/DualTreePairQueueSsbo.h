@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the SSBO that holds the queue of (particle BVH node, polygon BVH node) pairs 
+    for the dual-tree traversal (see ParticlePolygonDualTree.comp).  The queue's header doubles 
+    as the indirect dispatch arguments for each pass.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class DualTreePairQueueSsbo : public SsboBase
+{
+public:
+    DualTreePairQueueSsbo(unsigned int numParticles);
+    ~DualTreePairQueueSsbo() = default;
+    using SharedPtr = std::shared_ptr<DualTreePairQueueSsbo>;
+    using SharedConstPtr = std::shared_ptr<const DualTreePairQueueSsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+    void StartWithRootPair(int particleRootNodeIndex, int polygonRootNodeIndex) const;
+    unsigned int HalfSize() const;
+    static unsigned int IndirectDispatchOffsetBytes();
+
+private:
+    unsigned int _halfSize;
+};
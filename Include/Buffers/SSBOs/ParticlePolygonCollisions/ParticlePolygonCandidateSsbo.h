@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Include/Buffers/SSBOs/SsboBase.h"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Encapsulates the SSBO that holds each particle's list of candidate polygons from the 
+    dual-tree traversal (see ParticlePolygonDualTree.comp).
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticlePolygonCandidateSsbo : public SsboBase
+{
+public:
+    ParticlePolygonCandidateSsbo(unsigned int numParticles);
+    ~ParticlePolygonCandidateSsbo() = default;
+    using SharedPtr = std::shared_ptr<ParticlePolygonCandidateSsbo>;
+    using SharedConstPtr = std::shared_ptr<const ParticlePolygonCandidateSsbo>;
+
+    void ConfigureConstantUniforms(unsigned int computeProgramId) const override;
+    unsigned int NumItems() const;
+
+private:
+    unsigned int _numItems;
+};
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <vector>
+
 #include "Include/Buffers/SSBOs/SsboBase.h"
+#include "Include/Buffers/Particle.h"
 
 /*------------------------------------------------------------------------------------------------
 Description:
@@ -12,7 +15,13 @@ Description:
     Allocates enough space for 2x the number of requested particles.  The second half is used 
     during particle sorting.  There is no "swap" function in GPU programming, so the particles 
     need to be copied from the first half to the second half, then copied back to their sorted 
-    position.
+    position.  The index sort doesn't move the particles, so if it never physically sorts them 
+    either, then the second half is left off (see ParticleIndexSort.comp).
+
+    If PARTICLE_LAYOUT is PARTICLE_LAYOUT_ARRAYS (see ParticleLayout.comp), then the buffer is 
+    split into four arrays (position, previous position, velocity, and flags), each with its 
+    own second half, and each bound to its own binding.  It is still one buffer object.
+    If it is PARTICLE_LAYOUT_COMPACT, then it is one array of CompactParticles.
 Creator:    John Cox, 3/2017
 ------------------------------------------------------------------------------------------------*/
 class ParticleSsbo : public SsboBase
@@ -28,6 +37,12 @@ public:
 
 private:
     void ConfigureRender() override;
+    void UploadAsStructureOfArrays(const std::vector<Particle> &particles);
 
     unsigned int _numParticles;
+
+    // only used by the structure of arrays layout; the positions start at 0
+    unsigned int _prevPosOffsetBytes;
+    unsigned int _velOffsetBytes;
+    unsigned int _flagsOffsetBytes;
 };
\ No newline at end of file
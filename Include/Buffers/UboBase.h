@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    The uniform buffer counterpart to SsboBase.  Generates the buffer on construction and 
+    deletes it on destruction.  Derived classes allocate it and bind it to their uniform block 
+    binding (see UniformBlockBindings.comp).
+
+    Note: The ParticlePropertiesUbo used to derive from SsboBase just to get the buffer 
+    generated and deleted, which also got it a VAO, a draw style, and a vertex count that a 
+    uniform buffer has no use for.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class UboBase
+{
+public:
+    UboBase();
+    virtual ~UboBase();
+    using SharedPtr = std::shared_ptr<UboBase>;
+    using SharedConstPtr = std::shared_ptr<const UboBase>;
+
+    virtual void ConfigureConstantUniforms(unsigned int computeProgramId) const;
+
+    unsigned int BufferId() const;
+
+protected:
+    // can't be private because the derived classes need it
+    unsigned int _bufferId;
+};
@@ -16,7 +16,7 @@ class ParticleEmitterBar : public IParticleEmitter
 {
 public:
     ParticleEmitterBar(const glm::vec2 &p1, const glm::vec2 &p2, const glm::vec2 &emitDir,
-        const float minVel, const float maxVel);
+        const float minVel, const float maxVel, const int particleTypeIndex);
     using SHARED_PTR = std::shared_ptr<ParticleEmitterBar>;
     using CONST_SHARED_PTR = std::shared_ptr<const ParticleEmitterBar>;
 
@@ -27,6 +27,7 @@ public:
     glm::vec4 GetEmitDir() const;
     float GetMinVelocity() const;
     float GetMaxVelocity() const;
+    int GetParticleTypeIndex() const;
 
 private:
     glm::vec4 _start;
@@ -34,6 +35,7 @@ private:
     glm::vec4 _emitDir;
     float _minVel;
     float _maxVel;
+    int _particleTypeIndex;
 
     glm::vec4 _transformedStart;
     glm::vec4 _transformedEnd;
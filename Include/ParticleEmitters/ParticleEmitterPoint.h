@@ -16,7 +16,8 @@ class ParticleEmitterPoint : public IParticleEmitter
 {
 public:
     // emits randomly from the origin point
-    ParticleEmitterPoint(const glm::vec2 &emitterPos, const float minVel, const float maxVel);
+    ParticleEmitterPoint(const glm::vec2 &emitterPos, const float minVel, const float maxVel, 
+        const int particleTypeIndex);
     using SHARED_PTR = std::shared_ptr<ParticleEmitterPoint>;
     using CONST_SHARED_PTR = std::shared_ptr<const ParticleEmitterPoint>;
 
@@ -25,10 +26,12 @@ public:
     glm::vec4 GetPos() const;
     float GetMinVelocity() const;
     float GetMaxVelocity() const;
+    int GetParticleTypeIndex() const;
 
 private:
     glm::vec4 _pos;
     glm::vec4 _transformedPos;
     float _minVel;
     float _maxVel;
+    int _particleTypeIndex;
 };
@@ -0,0 +1,27 @@
+#pragma once
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    The CPU mirror of Random.comp.  Given the same emitter, emit ordinal, and frame, it 
+    generates the same numbers in the same order as the emission shaders do, so a particle's 
+    emission can be reproduced (or checked) on the CPU without reading the particle buffer 
+    back.
+
+    The seed and the PCG constants come from RandomSeed.comp, so the two sides can't drift 
+    apart.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+class ParticleRandom
+{
+public:
+    ParticleRandom(unsigned int emitterIndex, unsigned int emitOrdinal, unsigned int frame);
+
+    static unsigned int PcgHash(unsigned int value);
+
+    float OnRange0To1();
+    float OnRangeNeg1ToPos1();
+
+private:
+    unsigned int _state;
+};
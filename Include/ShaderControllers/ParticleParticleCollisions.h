@@ -5,10 +5,14 @@
 
 #include "Include/Buffers/SSBOs/ParticleSsbo.h"
 #include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleBvhNodeSsbo.h"
-#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticlePropertiesSsbo.h"
+#include "Include/Buffers/ParticlePropertiesUbo.h"
 #include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleSortingDataSsbo.h"
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleSortedIndexSsbo.h"
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleSweptBoxSsbo.h"
 #include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticlePrefixSumSsbo.h"
-#include "Include/Buffers/SSBOs/ParticleParticleCollisions/PotentialParticleParticleCollisionsSsbo.h"
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleNeighbourListReferenceSsbo.h"
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleCollisionVelocitySsbo.h"
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleContactSsbo.h"
 #include "Include/Buffers/SSBOs/VisualizationOnly/ParticleVelocityVectorGeometrySsbo.h"
 #include "Include/Buffers/SSBOs/VisualizationOnly/ParticleBoundingBoxGeometrySsbo.h"
 
@@ -24,12 +28,13 @@ namespace ShaderControllers
     class ParticleParticleCollisions
     {
     public:
-        ParticleParticleCollisions(const ParticleSsbo::SharedConstPtr particleSsbo, const ParticlePropertiesSsbo::SharedConstPtr particlePropertiesSsbo);
+        ParticleParticleCollisions(const ParticleSsbo::SharedConstPtr particleSsbo, const ParticlePropertiesUbo::SharedConstPtr particlePropertiesUbo);
         ~ParticleParticleCollisions();
 
-        void DetectAndResolve(bool withProfiling, bool generateGeometry) const;
+        void DetectAndResolve(float deltaTimeSec, bool withProfiling, bool generateGeometry);
         const VertexSsboBase &GetParticleVelocityVectorSsbo() const;
         const VertexSsboBase &GetParticleBoundingBoxSsbo() const;
+        void ReadNeighbourListRebuildCounts(unsigned int &numDecisions, unsigned int &numRebuilds) const;
 
     private:
         unsigned int _numParticles;
@@ -43,6 +48,8 @@ namespace ShaderControllers
         unsigned int _programIdPrefixScanStage3;
         unsigned int _programIdSortSortingDataWithPrefixSums;
         unsigned int _programIdSortParticles;
+        unsigned int _programIdSortParticleIndexes;
+        unsigned int _programIdRebuildParticleFreeList;
 
         // organization
         void AssembleBvhShaders();
@@ -53,43 +60,66 @@ namespace ShaderControllers
 
         // all that for the coup de grace
         void AssembleCollisionShaders();
-        unsigned int _programIdDetectCollisions;
-        unsigned int _programIdResolveCollisions;
+        unsigned int _programIdDetectAndResolveCollisions;
+        int _unifLocDetectAndResolveDeltaTimeSec;
+        unsigned int _programIdMeasureParticleDisplacement;
+        unsigned int _programIdDecideNeighbourListRebuild;
+        int _unifLocDecideRebuildNumWorkGroupsX;
+        int _unifLocDecideRebuildPrefixScanNumWorkGroupsX;
+
+        // the iterative alternatives to the above (see ParticleSolver.comp)
+        void AssembleContactSolverShaders();
+        unsigned int _programIdDetectContacts;
+        unsigned int _programIdColourContacts;
+        unsigned int _programIdSolveContacts;
+        unsigned int _programIdProjectContactConstraints;
+        int _unifLocProjectContactConstraintsDeltaTimeSec;
 
         // for drawing pretty things
         void AssembleGeometryCreationShaders();
         unsigned int _programIdGenerateParticleVelocityVectorGeometry;
         unsigned int _programIdGenerateParticleBoundingBoxGeometry;
 
-        void SortParticlesWithoutProfiling(unsigned int numWorkGroupsX, unsigned int numWorkGroupsXPrefixScan) const;
-        void SortParticlesWithProfiling(unsigned int numWorkGroupsX, unsigned int numWorkGroupsXPrefixScan) const;
+        // Note: The sorting and BVH generation dispatches are indirect, and the GPU sets them 
+        // to 0 work groups if the BVH is still good (see DecideNeighbourListRebuild.comp), so 
+        // they don't take work group counts.
+        void SortParticlesWithoutProfiling() const;
+        void SortParticlesWithProfiling() const;
 
-        void GenerateBvhWithoutProfiling(unsigned int numWorkGroupsX) const;
-        void GenerateBvhWithProfiling(unsigned int numWorkGroupsX) const;
+        void GenerateBvhWithoutProfiling() const;
+        void GenerateBvhWithProfiling() const;
 
         void DetectAndResolveCollisionsWithoutProfiling(unsigned int numWorkGroupsX) const;
         void DetectAndResolveCollisionsWithProfiling(unsigned int numWorkGroupsX) const;
 
-        // the "without profiling" and "with profiling" go through these same steps
-        void PrepareToSortParticles(unsigned int numWorkGroupsX) const;
-        void PrefixScan(unsigned int numWorkGroupsX, unsigned int bitNumber, unsigned int sortingDataReadOffset) const;
-        void SortSortingDataWithPrefixScan(unsigned int numWorkGroupsX, unsigned int bitNumber, unsigned int sortingDataReadOffset, unsigned int sortingDataWriteOffset) const;
-        void SortParticlesUsingSortingData(unsigned int numWorkGroupsX, unsigned int sortingDataReadOffset) const;
+        // skip sorting and BVH generation if the BVH is still good
+        void DecideIfNeighbourListsNeedRebuilding(unsigned int numWorkGroupsX, unsigned int numWorkGroupsXPrefixScan) const;
 
-        void PrepareForBinaryTree(unsigned int numWorkGroupsX) const;
-        void GenerateBinaryRadixTree(unsigned int numWorkGroupsX) const;
-        void MergeNodesIntoBvh(unsigned int numWorkGroupsX) const;
-        void DetectCollisions(unsigned int numWorkGroupsX) const;
-        void ResolveCollisions(unsigned int numWorkGroupsX) const;
+        // the "without profiling" and "with profiling" go through these same steps
+        void PrepareToSortParticles() const;
+        void PrefixScan(unsigned int bitNumber, unsigned int sortingDataReadOffset) const;
+        void SortSortingDataWithPrefixScan(unsigned int bitNumber, unsigned int sortingDataReadOffset, unsigned int sortingDataWriteOffset) const;
+        void SortParticlesUsingSortingData(unsigned int sortingDataReadOffset) const;
+
+        void PrepareForBinaryTree() const;
+        void GenerateBinaryRadixTree() const;
+        void MergeNodesIntoBvh() const;
+        void DetectAndResolveCollisions(unsigned int numWorkGroupsX) const;
+        void DetectAndColourContacts(unsigned int numWorkGroupsX) const;
+        void SolveContacts(unsigned int numWorkGroupsX, unsigned int programId, unsigned int numIterations) const;
 
         // for drawing pretty things
         void GenerateGeometry(unsigned int numWorkGroupsX) const;
 
         // buffers for sorting, BVH generation, and anything else that's necessary
         ParticleSortingDataSsbo _sortingDataSsbo;
+        ParticleSortedIndexSsbo _sortedIndexSsbo;
         ParticlePrefixSumSsbo _prefixSumSsbo;
         ParticleBvhNodeSsbo _bvhNodeSsbo;
-        PotentialParticleParticleCollisionsSsbo _potentialCollisionsSsbo;
+        ParticleSweptBoxSsbo _sweptBoxSsbo;
+        ParticleNeighbourListReferenceSsbo _neighbourListReferenceSsbo;
+        ParticleCollisionVelocitySsbo _collisionVelocitySsbo;
+        ParticleContactSsbo _contactSsbo;
         ParticleVelocityVectorGeometrySsbo _velocityVectorGeometrySsbo;
         ParticleBoundingBoxGeometrySsbo _boundingBoxGeometrySsbo;
 
@@ -3,13 +3,16 @@
 #include <string>
 
 #include "Include/Buffers/SSBOs/ParticleSsbo.h"
+#include "Include/Buffers/ParticlePropertiesUbo.h"
 #include "Include/Buffers/SSBOs/ParticlePolygonCollisions/CollidablePolygonSsbo.h"
 #include "Include/Buffers/SSBOs/ParticlePolygonCollisions/CollidablePolygonBvhNodeSsbo.h"
 #include "Include/Buffers/SSBOs/ParticlePolygonCollisions/CollidablePolygonSortingDataSsbo.h"
 #include "Include/Buffers/SSBOs/ParticlePolygonCollisions/CollidablePolygonPrefixSumSsbo.h"
-#include "Include/Buffers/SSBOs/ParticlePolygonCollisions/PotentialParticlePolygonCollisionsSsbo.h"
+#include "Include/Buffers/SSBOs/ParticlePolygonCollisions/DualTreePairQueueSsbo.h"
+#include "Include/Buffers/SSBOs/ParticlePolygonCollisions/ParticlePolygonCandidateSsbo.h"
 #include "Include/Buffers/SSBOs/VisualizationOnly/CollidablePolygonBoundingBoxGeometrySsbo.h"
 #include "Include/Buffers/SSBOs/VisualizationOnly/CollidablePolygonSurfaceNormalGeometrySsbo.h"
+#include "Include/Buffers/CollidablePolygonSdf.h"
 
 
 namespace ShaderControllers
@@ -24,7 +27,7 @@ namespace ShaderControllers
     class ParticlePolygonCollisions
     {
     public:
-        ParticlePolygonCollisions(const std::string &blenderObjFilePath, const ParticleSsbo::SharedConstPtr particleSsbo);
+        ParticlePolygonCollisions(const std::string &blenderObjFilePath, const ParticleSsbo::SharedConstPtr particleSsbo, const ParticlePropertiesUbo::SharedConstPtr particlePropertiesUbo);
         ~ParticlePolygonCollisions();
 
         void DetectAndResolve(bool withProfiling) const;
@@ -52,8 +55,12 @@ namespace ShaderControllers
 
         // all that for the coup de grace
         void AssembleCollisionShaders();
-        unsigned int _programIdDetectCollisions;
-        unsigned int _programIdResolveCollisions;
+        unsigned int _programIdDetectAndResolveWithBvh;
+        unsigned int _programIdDetectAndResolveBruteForce;
+        unsigned int _programIdDetectAndResolveWithSdf;
+        unsigned int _programIdPrepareDualTreePass;
+        unsigned int _programIdExpandDualTreePairs;
+        unsigned int _programIdDetectAndResolveDualTree;
 
         // for drawing pretty things
         void AssembleGeometryCreationShaders();
@@ -62,8 +69,11 @@ namespace ShaderControllers
         void GenerateCollidablePolygonBvh() const;
         void SortCollidablePolygons(unsigned int numWorkGroupsX, unsigned int numWorkGroupsXPrefixScan) const;
         void GenerateBvh(unsigned int numWorkGroupsX) const;
-        void DetectCollisions(unsigned int numWorkGroupsX) const;
-        void ResolveCollisions(unsigned int numWorkGroupsX) const;
+        void DetectAndResolveWithBvh(unsigned int numWorkGroupsX) const;
+        void DetectAndResolveBruteForce(unsigned int numWorkGroupsX) const;
+        void DetectAndResolveWithSdf(unsigned int numWorkGroupsX) const;
+        void DetectAndResolveDualTree(unsigned int numWorkGroupsX) const;
+        void ExpandDualTreePairs(unsigned int passNumber) const;
         void GenerateBoundingBoxGeometry() const;
 
         void PrepareToSortGeometry(unsigned int numWorkGroupsX) const;
@@ -77,10 +87,40 @@ namespace ShaderControllers
 
         // buffers for all that jazz
         CollidablePolygonSsbo _collideablePolygonSsbo;
+
+        // if there are only a few polygons, then checking every particle against every polygon 
+        // is faster than building and traversing a BVH (see 
+        // DetectAndResolveParticlePolygonCollisionsBruteForce.comp)
+        // Note: Must be declared after the polygon SSBO because it needs the polygon count.
+        // Also Note: 2048 is 4 tiles at a work group size of 512.  Each tile is one coalesced 
+        // 8KB read per work group and then WORK_GROUP_SIZE_X segment tests per thread out of 
+        // shared memory, with no divergence.  A BVH traversal of a few thousand polygons is 
+        // ~11 levels of dependent reads per particle.  The top levels come out of shared memory 
+        // (see BvhNodeCache.comp), but the rest are scattered global reads, so the tiles still 
+        // come out ahead.  The geometry doesn't move, so the BVH build only happens once and 
+        // doesn't count against it.
+        // Also Also Note: airfoil.obj is well under 2048 polygons, so without an override it 
+        // always takes brute force.  If USE_PARTICLE_POLYGON_DUAL_TREE is on (see 
+        // ParticlePolygonDualTree.comp) or FORCE_PARTICLE_POLYGON_BVH is true, then the BVH is 
+        // used no matter how few polygons there are.  The constructor says which path it took.
+        static const unsigned int MAX_POLYGONS_FOR_BRUTE_FORCE = 2048;
+        static const bool FORCE_PARTICLE_POLYGON_BVH = false;
+        bool _useBruteForce;
+
+        // if on, then the geometry is baked into a signed distance field instead (see 
+        // CollidablePolygonSdf.comp)
+        // Note: Null if not in use.
+        CollidablePolygonSdf::SharedConstPtr _sdf;
+
+        // if on, then the particle BVH and the polygon BVH are walked together (see 
+        // ParticlePolygonDualTree.comp)
+        bool _useDualTree;
+
         CollidablePolygonSortingDataSsbo _sortingDataSsbo;
         CollidablePolygonPrefixSumSsbo _prefixSumSsbo;
         CollidablePolygonBvhNodeSsbo _bvhNodeSsbo;
-        PotentialParticlePolygonCollisionsSsbo _potentialCollisionsSsbo;
+        DualTreePairQueueSsbo _dualTreePairQueueSsbo;
+        ParticlePolygonCandidateSsbo _particlePolygonCandidateSsbo;
 
         // for visualization only
         CollidablePolygonBoundingBoxGeometrySsbo _boundingBoxGeometrySsbo;
@@ -4,6 +4,8 @@
 #include <memory>
 
 #include "Include/Buffers/SSBOs/ParticleSsbo.h"
+#include "Include/Buffers/SSBOs/ParticleFreeListSsbo.h"
+#include "Include/Buffers/SSBOs/ParticleEmitterSsbo.h"
 #include "Include/ParticleEmitters/IParticleEmitter.h"
 #include "Include/ParticleEmitters/ParticleEmitterPoint.h"
 #include "Include/ParticleEmitters/ParticleEmitterBar.h"
@@ -21,8 +23,17 @@ namespace ShaderControllers
         (1) Point emitters eject particles in all directions
         (2) Bar emitters eject particles outwards from a 2D plane 
 
-        These was deemed different enough to justify splitting the once-one shader into two, one
-        for each type of emitter.  This shader controller has the info for both.
+        These used to be two shaders with a dispatch (and a handful of uniforms) for every 
+        emitter.  Now every emitter is flattened into a ParticleEmitterDescriptor, they are all 
+        uploaded in one go, and one shader handles both types in a single dispatch, so the cost 
+        on the CPU side doesn't depend on how many emitters there are.
+
+        Inactive particles are found with a free list (see ParticleFreeListBuffer.comp), so the 
+        dispatch only has as many threads as there are particles being emitted.
+
+        The random numbers for each emitted particle are keyed by its emitter, its place in 
+        that emitter's batch, and a frame counter that goes up on every ResetParticles(...) call 
+        (see Random.comp), so the particles don't need to be seeded on startup.
 
         Note: Unlike in previous Particle-related demos, shared pointers are used and the 
         ParticleReset emitter is now an "owner" of the emitters.  By using shared pointers, the 
@@ -45,27 +56,25 @@ namespace ShaderControllers
         void AddEmitter(ParticleEmitterBar::CONST_SHARED_PTR barEmitter);
 
         void ResetParticles(unsigned int particlesPerEmitterPerFrame);
+        float MaxEmissionSpeed() const;
 
     private:
-        unsigned int _totalParticleCount;
-        unsigned int _computeProgramIdBarEmitters;
-        unsigned int _computeProgramIdPointEmitters;
-
-        // some of these uniforms had to be split into two versions to accomodate both shaders
-
-        // specific to point emitter
-        int _unifLocPointEmitterCenter;
-        int _unifLocPointMaxParticleEmitCount;
-        int _unifLocPointMinParticleVelocity;
-        int _unifLocPointMaxParticleVelocity;
-
-        // specific to bar emitter
-        int _unifLocBarEmitterP1;
-        int _unifLocBarEmitterP2;
-        int _unifLocBarEmitterEmitDir;
-        int _unifLocBarMaxParticleEmitCount;
-        int _unifLocBarMinParticleVelocity;
-        int _unifLocBarMaxParticleVelocity;
+        void CheckRandomMirror() const;
+
+        unsigned int _computeProgramIdEmitters;
+        unsigned int _computeProgramIdPrepareEmission;
+
+        // keys the emission shader's random numbers (see Random.comp)
+        unsigned int _randomFrame;
+
+        // the fastest that any particle could have been emitted on the last ResetParticles(...)
+        float _maxEmissionSpeed;
+
+        ParticleFreeListSsbo _freeListSsbo;
+        ParticleEmitterSsbo _emitterSsbo;
+
+        // rebuilt every frame, but kept around so that it isn't reallocated every frame
+        std::vector<ParticleEmitterDescriptor> _emitterDescriptors;
 
         // all the updating heavy lifting goes on in the compute shader, so CPU cache coherency 
         // is not a concern for emitter storage on the CPU side and a std::vector<...> is 
@@ -73,7 +82,6 @@ namespace ShaderControllers
         // Note: The compute shader has no concept of inheritance.  Rather than store a single 
         // collection of IParticleEmitter pointers and cast them to either point or bar emitters 
         // on every update, just store them separately.
-        static const int MAX_EMITTERS = 4;
         std::vector<ParticleEmitterPoint::CONST_SHARED_PTR> _pointEmitters;
         std::vector<ParticleEmitterBar::CONST_SHARED_PTR> _barEmitters;
     };
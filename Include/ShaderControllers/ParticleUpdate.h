@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Include/Buffers/SSBOs/ParticleSsbo.h"
+#include "Include/Buffers/SSBOs/ParticleMaxSpeedSsbo.h"
+#include "Include/Buffers/ParticlePropertiesUbo.h"
+#include "Include/Buffers/ParticleForceFieldUbo.h"
 #include "Include/Buffers/PersistentAtomicCounterBuffer.h"
 
 #include "ThirdParty/glm/vec4.hpp"
@@ -10,9 +13,12 @@ namespace ShaderControllers
     /*--------------------------------------------------------------------------------------------
     Description:
         Encapsulates the following particle updates via compute shader:
-        (1) Updates particle positions based on their velocity in the previous frame.
+        (1) Updates particle positions based on their velocity in the previous frame, after 
+            applying any force fields to the velocity (see ParticleForceFields.comp).
         (2) If any particles have gone out of bounds, flag them as inactive.
         (3) Emit as many particles for this frame as each emitter allows.
+        (4) If USE_FUSED_PARTICLE_UPDATE is on, write each particle's Morton Code and bounding 
+            box for the particle-particle collisions (see FusedParticleUpdate.comp).
 
         There is one compute shader that does this, and this class is built to communicate with 
         and summon that particular shader.
@@ -24,11 +30,16 @@ namespace ShaderControllers
     class ParticleUpdate
     {
     public:
-        ParticleUpdate(const ParticleSsbo::SharedConstPtr &ssboToUpdate);
+        ParticleUpdate(const ParticleSsbo::SharedConstPtr &ssboToUpdate, const ParticlePropertiesUbo::SharedConstPtr &particlePropertiesUbo);
         ~ParticleUpdate();
 
         void Update(float deltaTimeSec);
+        void DeriveVelocities(float deltaTimeSec);
+        unsigned int ChooseNumSubSteps(float deltaTimeSec, float maxEmissionSpeed);
         unsigned int NumActiveParticles() const;
+        unsigned int NumSubSteps() const;
+        float MaxSpeedInRadii() const;
+        bool AddForceField(const ParticleForceField &forceField);
 
     private:
         unsigned int _totalParticleCount;
@@ -37,5 +48,19 @@ namespace ShaderControllers
         
         // these uniforms are specific to this shader
         int _unifLocDeltaTimeSec;
+
+        // only used by the XPBD solver (see ParticleSolver.comp)
+        unsigned int _deriveVelocityProgramId;
+        int _unifLocDeriveVelocityDeltaTimeSec;
+
+        // for choosing the number of sub-steps (see SubStepping.comp)
+        unsigned int _measureMaxSpeedProgramId;
+        ParticleMaxSpeedSsbo _maxSpeedSsbo;
+        unsigned int _numSubSteps;
+        float _maxSpeedInRadii;
+        float _minCollisionRadius;
+
+        // gravity, drag, attractors, etc.
+        ParticleForceFieldUbo _forceFieldUbo;
     };
 }
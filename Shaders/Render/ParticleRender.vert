@@ -5,6 +5,10 @@
 // Also Note: The vec2s are provided as vec4s on the CPU side and specified as such in the 
 // vertex array attributes, but it is ok to only take them as a vec2, as I am doing for this 
 // 2D demo.
+// Also Also Note: With the structure of arrays or compact particle layouts (see 
+// ParticleLayout.comp), the positions and velocity are only 2 floats (or 2 half floats) and 
+// the flags are ints or bytes, but ParticleSsbo::ConfigureRender() sets up the attributes so 
+// that they arrive here the same either way.
 layout (location = 0) in vec4 currPos;  
 layout (location = 1) in vec4 prevPos;  
 layout (location = 2) in vec4 vel;  
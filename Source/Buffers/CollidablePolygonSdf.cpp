@@ -0,0 +1,356 @@
+#include "Include/Buffers/CollidablePolygonSdf.h"
+#include "Include/Geometry/BlenderLoad.h"
+#include "Include/Geometry/PolygonFace.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "ThirdParty/glm/vec2.hpp"
+#include "ThirdParty/glm/geometric.hpp"
+#include "ThirdParty/glm/common.hpp"
+#include "Shaders/Compute/ParticleRegionBoundaries.comp"
+#include "Shaders/Compute/Collisions/ParticlePolygon/CollidablePolygonSdf.comp"
+
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+using std::cout;
+using std::endl;
+
+
+// each texel is the signed distance, then the X and Y of the direction away from the nearest
+// polygon
+static const unsigned int NUM_FLOATS_PER_TEXEL = 3;
+
+// bump this if the baking changes so that old files on disk are thrown out
+static const unsigned int SDF_FILE_VERSION = 1;
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Goes at the start of the cached .sdf file.  If any of it doesn't match what would be baked
+    right now, then the file is stale.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+struct SdfFileHeader
+{
+    unsigned int _version;
+    unsigned int _resolution;
+    float _regionMinX;
+    float _regionMinY;
+    float _regionRangeX;
+    float _regionRangeY;
+    unsigned int _numPolygons;
+    unsigned int _polygonChecksum;
+};
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A helper function to clean up the construction.  Same as CollidablePolygonSsbo: all the
+    geometry in the file is used.
+Parameters:
+    blenderMeshFilePath     The path to the .obj file
+    loadHere                Emptied and then filled with the file's polygons.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+static void LoadPolygons(const std::string &blenderMeshFilePath, std::vector<PolygonFace> &loadHere)
+{
+    loadHere.clear();
+
+    BlenderLoad bl(blenderMeshFilePath);
+    const BlenderLoad::GeometryByObject &allGeometry = bl.Geometry();
+    for (BlenderLoad::GeometryByObject::const_iterator objectItr = allGeometry.begin();
+        objectItr != allGeometry.end(); objectItr++)
+    {
+        const BlenderLoad::PolygonCollection &objectPolygons = objectItr->second;
+        loadHere.insert(loadHere.end(), objectPolygons.begin(), objectPolygons.end());
+    }
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A 32-bit FNV-1a hash of the polygons.  It doesn't need to be secure; it just needs to
+    change if someone edits the .obj file.
+Parameters:
+    polygons    Self-explanatory.
+Returns:
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+static unsigned int PolygonChecksum(const std::vector<PolygonFace> &polygons)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(polygons.data());
+    size_t numBytes = polygons.size() * sizeof(PolygonFace);
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < numBytes; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Calculates the signed distance and the direction away from the nearest polygon for every
+    texel in rows firstRow, firstRow + rowStride, firstRow + 2*rowStride, etc.  Every thread
+    gets a different firstRow, so the rows are shared evenly and no two threads write the same
+    texel.
+
+    The sign comes from the nearest polygon's surface normal: negative if the texel is behind
+    it.  Polygons that share an end point are equally near to texels around that end point, so
+    for those the one that the texel is most squarely in front of (or behind) decides.
+    Otherwise texels around the outside of a sharp corner could end up "inside".
+Parameters:
+    polygons    All the collidable geometry.
+    firstRow    See Description.
+    rowStride   See Description.
+    texels      COLLIDABLE_POLYGON_SDF_RESOLUTION^2 * NUM_FLOATS_PER_TEXEL floats.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+static void BakeRows(const std::vector<PolygonFace> &polygons, unsigned int firstRow,
+    unsigned int rowStride, std::vector<float> &texels)
+{
+    const unsigned int resolution = COLLIDABLE_POLYGON_SDF_RESOLUTION;
+    const float texelWidth = PARTICLE_REGION_RANGE_X / resolution;
+    const float texelHeight = PARTICLE_REGION_RANGE_Y / resolution;
+
+    // Note: If two polygons are within this distance of each other, then they count as
+    // "equally near".
+    const float tieDistance = 0.000001f;
+
+    for (unsigned int row = firstRow; row < resolution; row += rowStride)
+    {
+        for (unsigned int column = 0; column < resolution; column++)
+        {
+            // sample at the texel's center, which is where the GPU will get exactly this value
+            glm::vec2 pos(
+                PARTICLE_REGION_MIN_X + ((column + 0.5f) * texelWidth),
+                PARTICLE_REGION_MIN_Y + ((row + 0.5f) * texelHeight));
+
+            float nearestDist = FLT_MAX;
+            float nearestSide = 0.0f;
+            glm::vec2 awayFromNearest(0.0f, 0.0f);
+            glm::vec2 nearestNormal(0.0f, 1.0f);
+            for (size_t polygonIndex = 0; polygonIndex < polygons.size(); polygonIndex++)
+            {
+                const PolygonFace &face = polygons[polygonIndex];
+                glm::vec2 start(face._start._position);
+                glm::vec2 polygon = glm::vec2(face._end._position) - start;
+                float lengthSqr = glm::dot(polygon, polygon);
+                float fraction = (lengthSqr > 0.0f) ?
+                    glm::clamp(glm::dot(pos - start, polygon) / lengthSqr, 0.0f, 1.0f) : 0.0f;
+                glm::vec2 away = pos - (start + (fraction * polygon));
+                float dist = glm::length(away);
+
+                // Note: Both vertices normals are the same for any given PolygonFace.
+                glm::vec2 normal(face._start._normal);
+                float side = glm::dot(away, normal);
+
+                bool isNearer = dist < (nearestDist - tieDistance);
+                bool isTiedAndSquarer = (dist <= (nearestDist + tieDistance)) &&
+                    (std::fabs(side) > std::fabs(nearestSide));
+                if (isNearer || isTiedAndSquarer)
+                {
+                    nearestDist = glm::min(dist, nearestDist);
+                    nearestSide = side;
+                    awayFromNearest = away;
+                    nearestNormal = normal;
+                }
+            }
+
+            float sign = (nearestSide < 0.0f) ? -1.0f : +1.0f;
+
+            // the gradient points towards more distance, so it is "away" outside of the
+            // geometry and "towards" inside it
+            // Note: Right on a polygon there is no "away", so use the surface normal.
+            float awayLength = glm::length(awayFromNearest);
+            glm::vec2 gradient = (awayLength > 0.0f) ?
+                (sign / awayLength) * awayFromNearest : nearestNormal;
+
+            size_t texelIndex = ((row * resolution) + column) * NUM_FLOATS_PER_TEXEL;
+            // Note: No polygons at all means nothing is near.
+            nearestDist = (nearestDist == FLT_MAX) ? PARTICLE_REGION_RANGE_X : nearestDist;
+            texels[texelIndex + 0] = sign * nearestDist;
+            texels[texelIndex + 1] = gradient.x;
+            texels[texelIndex + 2] = gradient.y;
+        }
+    }
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Splits BakeRows(...) between all the CPU's threads.
+Parameters:
+    polygons    All the collidable geometry.
+    texels      Resized and filled.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+static void Bake(const std::vector<PolygonFace> &polygons, std::vector<float> &texels)
+{
+    const unsigned int resolution = COLLIDABLE_POLYGON_SDF_RESOLUTION;
+    texels.resize(resolution * resolution * NUM_FLOATS_PER_TEXEL);
+
+    // Note: hardware_concurrency() is allowed to return 0 if it can't tell.
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    numThreads = (numThreads == 0) ? 1 : numThreads;
+
+    std::vector<std::thread> threads;
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+    {
+        threads.push_back(std::thread(BakeRows, std::cref(polygons), threadIndex, numThreads,
+            std::ref(texels)));
+    }
+
+    for (size_t threadIndex = 0; threadIndex < threads.size(); threadIndex++)
+    {
+        threads[threadIndex].join();
+    }
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Loads a previously baked field from disk.
+Parameters:
+    filePath        Self-explanatory.
+    expectedHeader  What the file should start with.
+    texels          Resized and filled if the file is good.
+Returns:
+    True if the file existed and matched the expected header, otherwise false.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+static bool LoadCachedSdf(const std::string &filePath, const SdfFileHeader &expectedHeader,
+    std::vector<float> &texels)
+{
+    std::ifstream inFile(filePath, std::ios::binary);
+    if (!inFile.is_open())
+    {
+        return false;
+    }
+
+    SdfFileHeader header;
+    inFile.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!inFile || memcmp(&header, &expectedHeader, sizeof(header)) != 0)
+    {
+        return false;
+    }
+
+    texels.resize(header._resolution * header._resolution * NUM_FLOATS_PER_TEXEL);
+    inFile.read(reinterpret_cast<char *>(texels.data()), texels.size() * sizeof(float));
+    return !inFile.fail();
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Saves a freshly baked field to disk so that the next run can skip the bake.
+Parameters:
+    filePath    Self-explanatory.
+    header      Goes at the start of the file.
+    texels      Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+static void SaveCachedSdf(const std::string &filePath, const SdfFileHeader &header,
+    const std::vector<float> &texels)
+{
+    std::ofstream outFile(filePath, std::ios::binary);
+    if (!outFile.is_open())
+    {
+        // not the end of the world; it will just be baked again next time
+        cout << "could not save signed distance field to '" << filePath << "'" << endl;
+        return;
+    }
+
+    outFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char *>(texels.data()), texels.size() * sizeof(float));
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Gives members initial values.  Loads the geometry, loads the cached field or bakes a new one
+    if the cached one is missing or stale, and uploads it to a texture.
+Parameters:
+    blenderMeshFilePath     The path to the .obj file
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+CollidablePolygonSdf::CollidablePolygonSdf(const std::string &blenderMeshFilePath) :
+    _textureId(0)
+{
+    std::vector<PolygonFace> polygons;
+    LoadPolygons(blenderMeshFilePath, polygons);
+
+    // Note: Zero it first so that any padding between members doesn't throw off the memcmp(...)
+    // when loading.
+    SdfFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header._version = SDF_FILE_VERSION;
+    header._resolution = COLLIDABLE_POLYGON_SDF_RESOLUTION;
+    header._regionMinX = PARTICLE_REGION_MIN_X;
+    header._regionMinY = PARTICLE_REGION_MIN_Y;
+    header._regionRangeX = PARTICLE_REGION_RANGE_X;
+    header._regionRangeY = PARTICLE_REGION_RANGE_Y;
+    header._numPolygons = polygons.size();
+    header._polygonChecksum = PolygonChecksum(polygons);
+
+    std::string cacheFilePath = blenderMeshFilePath + ".sdf";
+    std::vector<float> texels;
+    if (LoadCachedSdf(cacheFilePath, header, texels))
+    {
+        cout << "loaded signed distance field from '" << cacheFilePath << "'" << endl;
+    }
+    else
+    {
+        cout << "baking signed distance field for " << polygons.size() << " polygons" << endl;
+        Bake(polygons, texels);
+        SaveCachedSdf(cacheFilePath, header, texels);
+    }
+
+    // Note: Linear filtering between texels gives a smooth distance and gradient.  Clamp to
+    // edge so that nothing wraps around to the other side of the particle region.
+    glGenTextures(1, &_textureId);
+    glActiveTexture(GL_TEXTURE0 + COLLIDABLE_POLYGON_SDF_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, _textureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, COLLIDABLE_POLYGON_SDF_RESOLUTION,
+        COLLIDABLE_POLYGON_SDF_RESOLUTION, 0, GL_RGB, GL_FLOAT, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Cleans up the texture.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+CollidablePolygonSdf::~CollidablePolygonSdf()
+{
+    glDeleteTextures(1, &_textureId);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Binds the field to COLLIDABLE_POLYGON_SDF_TEXTURE_UNIT, which is where
+    DetectAndResolveParticlePolygonCollisionsWithSdf.comp expects it.
+
+    Note: Other things (like the frame rate text) bind their own textures, so call this before
+    every dispatch that samples the field.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void CollidablePolygonSdf::BindToTextureUnit() const
+{
+    glActiveTexture(GL_TEXTURE0 + COLLIDABLE_POLYGON_SDF_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, _textureId);
+    glActiveTexture(GL_TEXTURE0);
+}
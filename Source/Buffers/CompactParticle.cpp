@@ -0,0 +1,62 @@
+#include "Include/Buffers/CompactParticle.h"
+
+#include "ThirdParty/glm/packing.hpp"
+#include "Shaders/Compute/ParticleLayout.comp"
+#include "Shaders/Compute/MaxParticleTypes.comp"
+#include "Shaders/Compute/ParticleSleep.comp"
+#include "Shaders/Compute/Collisions/MaxNumPotentialCollisions.comp"
+
+// the flags are read as signed bytes by ParticleRender.vert (see ParticleLayout.comp)
+static_assert(MAX_PARTICLE_TYPES <= 127, "packed particle type index must fit in a signed byte");
+static_assert(MAX_NUM_POTENTIAL_COLLISIONS <= 127, "packed particle nearby count must fit in a signed byte");
+static_assert(PARTICLE_SLEEP_FRAMES <= 127, "packed particle sleep counter must fit in a signed byte");
+static_assert(sizeof(CompactParticle) == 24, "CompactParticle must match ParticleBuffer.comp");
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Gives members initial values.  Same as a default Particle.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+CompactParticle::CompactParticle() :
+    CompactParticle(Particle())
+{
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Packs a Particle the same way as WriteParticle(...) in ParticleBuffer.comp.
+Parameters:
+    p   Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+CompactParticle::CompactParticle(const Particle &p) :
+    _currPos(p._currPos),
+    _prevPos(p._prevPos),
+    _packedVel(glm::packHalf2x16(glm::vec2(p._vel))),
+    _packedFlags(PackParticleFlags(p))
+{
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Packs a Particle's type, nearby count, "is active" flag, and sleep counter one byte apiece, 
+    the same way as PackParticleFlags(...) in ParticleBuffer.comp.  The static asserts at the 
+    top of this file keep them all under a byte.
+Parameters:
+    p   Self-explanatory.
+Returns:
+    The packed flags.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int PackParticleFlags(const Particle &p)
+{
+    return
+        ((static_cast<unsigned int>(p._particleTypeIndex) & 0xffu) << PACKED_PARTICLE_TYPE_INDEX_SHIFT) |
+        ((static_cast<unsigned int>(p._numNearbyParticles) & 0xffu) << PACKED_PARTICLE_NUM_NEARBY_PARTICLES_SHIFT) |
+        ((static_cast<unsigned int>(p._isActive) & 0xffu) << PACKED_PARTICLE_IS_ACTIVE_SHIFT) |
+        ((static_cast<unsigned int>(p._sleepCounter) & 0xffu) << PACKED_PARTICLE_SLEEP_COUNTER_SHIFT);
+}
@@ -0,0 +1,94 @@
+#include "Include/Buffers/ParticleForceFieldUbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/UniformBlockBindings.comp"
+#include "Shaders/Compute/ParticleForceFields.comp"
+
+#include <stdio.h>
+#include <vector>
+
+// std140 puts the array on the next 16-byte boundary after the count
+static const unsigned int FORCE_FIELD_ARRAY_OFFSET_BYTES = 16;
+
+static_assert(sizeof(ParticleForceField) == 32, "ParticleForceField must match the std140 layout in ParticleForceFieldBuffer.comp");
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then gives derived class members initial values and allocates space
+    for the whole uniform block.  It starts with no force fields.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleForceFieldUbo::ParticleForceFieldUbo() :
+    UboBase(),
+    _numForceFields(0)
+{
+    // Note: The uniform block is always MAX_PARTICLE_FORCE_FIELDS long, and the buffer must be
+    // at least that big.  All zeros is a count of 0.
+    std::vector<unsigned char> v(FORCE_FIELD_ARRAY_OFFSET_BYTES + (MAX_PARTICLE_FORCE_FIELDS * sizeof(ParticleForceField)));
+
+    // now bind this new buffer to the dedicated uniform block binding location
+    glBindBufferBase(GL_UNIFORM_BUFFER, PARTICLE_FORCE_FIELD_UNIFORM_BLOCK_BINDING, _bufferId);
+
+    // and fill it with new data
+    glBindBuffer(GL_UNIFORM_BUFFER, _bufferId);
+    glBufferData(GL_UNIFORM_BUFFER, v.size(), v.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    There are no uniforms to set.  The number of force fields is in the uniform block itself.
+Parameters:
+    computeProgramId    Unused.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleForceFieldUbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Uploads the new force field into the next free slot and then uploads the new count.  Only
+    the changed parts of the buffer are sent.
+Parameters:
+    forceField  Self-explanatory.
+Returns:
+    True if it was added, otherwise false (the table is full).
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+bool ParticleForceFieldUbo::AddForceField(const ParticleForceField &forceField)
+{
+    if (_numForceFields >= MAX_PARTICLE_FORCE_FIELDS)
+    {
+        fprintf(stderr, "Cannot add more than %d force fields (see ParticleForceFields.comp)\n", MAX_PARTICLE_FORCE_FIELDS);
+        return false;
+    }
+
+    unsigned int offsetBytes = FORCE_FIELD_ARRAY_OFFSET_BYTES + (_numForceFields * sizeof(ParticleForceField));
+    _numForceFields++;
+    int numForceFields = static_cast<int>(_numForceFields);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, _bufferId);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetBytes, sizeof(ParticleForceField), &forceField);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(numForceFields), &numForceFields);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    return true;
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A simple getter.
+Parameters: None
+Returns:
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleForceFieldUbo::NumForceFields() const
+{
+    return _numForceFields;
+}
@@ -0,0 +1,139 @@
+#include "Include/Buffers/ParticlePropertiesUbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/UniformBlockBindings.comp"
+#include "Shaders/Compute/MaxParticleTypes.comp"
+#include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/ShaderStorage.h"
+
+#include "Include/Buffers/ParticleProperties.h"
+
+#include <algorithm>
+#include <vector>
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A helper function to clean up the construction.
+Parameters: 
+    An STL container of ParticleProperty structures.  It will be emptied and built from scratch.
+Returns:    None
+Creator:    John Cox, 5/2017
+------------------------------------------------------------------------------------------------*/
+static void GenerateParticleProperties(std::vector<ParticleProperties> &initThis)
+{
+    static_assert(ParticleProperties::ParticleType::NUM_PARTICLE_PROPERTIES <= MAX_PARTICLE_TYPES, 
+        "too many particle types for the uniform block (see MaxParticleTypes.comp)");
+
+    // Note: The uniform block is always MAX_PARTICLE_TYPES long, and the buffer must be at 
+    // least that big, so the unused types are all duds.
+    initThis.clear();
+    initThis.resize(MAX_PARTICLE_TYPES);
+
+    ParticleProperties pp;
+
+    // the dud property
+    initThis[ParticleProperties::ParticleType::NO_PARTICLE_TYPE] = pp;
+
+    // generic
+    // Note: Restitution 1 and friction 0 are perfectly elastic, frictionless bounces.
+    pp._mass = 0.05f;
+    pp._collisionRadius = 0.0020f;
+    //pp._collisionRadius = 0.003f;
+    pp._restitution = 1.0f;
+    pp._friction = 0.0f;
+    initThis[ParticleProperties::ParticleType::GENERIC] = pp;
+
+    // heavy
+    // Note: 4x the mass of a generic particle, so a generic particle bounces off of it at 
+    // nearly full speed while it barely slows down.  A contact takes the smaller restitution 
+    // and the geometric mean of the frictions (see ParticlePropertiesBuffer.comp), so 
+    // generic-heavy contacts lose some speed but stay frictionless.
+    pp._mass = 0.2f;
+    pp._collisionRadius = 0.0030f;
+    pp._restitution = 0.6f;
+    pp._friction = 0.2f;
+    initThis[ParticleProperties::ParticleType::HEAVY] = pp;
+}
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then gives derived class members initial values and allocates space 
+    for the uniform buffer.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 5/2017
+------------------------------------------------------------------------------------------------*/
+ParticlePropertiesUbo::ParticlePropertiesUbo() :
+    UboBase(),
+    _numProperties(0),
+    _minCollisionRadius(0.0f)
+{
+    std::vector<ParticleProperties> v;
+    GenerateParticleProperties(v);
+    _numProperties = ParticleProperties::ParticleType::NUM_PARTICLE_PROPERTIES;
+
+    // Note: Skip the dud.  Its radius is 0.
+    _minCollisionRadius = v[ParticleProperties::ParticleType::GENERIC]._collisionRadius;
+    for (unsigned int typeIndex = ParticleProperties::ParticleType::GENERIC; typeIndex < _numProperties; typeIndex++)
+    {
+        _minCollisionRadius = std::min(_minCollisionRadius, v[typeIndex]._collisionRadius);
+    }
+
+    // now bind this new buffer to the dedicated uniform block binding location
+    glBindBufferBase(GL_UNIFORM_BUFFER, PARTICLE_PROPERTIES_UNIFORM_BLOCK_BINDING, _bufferId);
+
+    // and fill it with new data
+    // Note: It never changes.
+    glBindBuffer(GL_UNIFORM_BUFFER, _bufferId);
+    glBufferData(GL_UNIFORM_BUFFER, v.size() * sizeof(ParticleProperties), v.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Defines the number of particle types that are actually in use in the specified shader.
+Parameters: 
+    computeProgramId    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 5/2017
+------------------------------------------------------------------------------------------------*/
+void ParticlePropertiesUbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+    ShaderStorage &shaderStorageRef = ShaderStorage::GetInstance();
+    unsigned int bufferSizeUnifLoc = shaderStorageRef.GetUniformLocation(computeProgramId, "uNumParticleProperties");
+
+    // the uniform should remain constant after this 
+    glUseProgram(computeProgramId);
+    glUniform1ui(bufferSizeUnifLoc, _numProperties);
+    glUseProgram(0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A simple getter for the value that was generated on creation.
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 6/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticlePropertiesUbo::NumProperties() const
+{
+    return _numProperties;
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A simple getter for the smallest collision radius of any particle type that is in use.  
+    The CPU doesn't know which type is fastest, so this is the conservative radius for turning 
+    a speed into radii per second (see ParticleUpdate::ChooseNumSubSteps(...)).
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+float ParticlePropertiesUbo::MinCollisionRadius() const
+{
+    return _minCollisionRadius;
+}
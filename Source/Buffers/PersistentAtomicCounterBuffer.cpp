@@ -8,16 +8,19 @@
 /*------------------------------------------------------------------------------------------------
 Description:
     Gives members initial values.
-    Generates a persistently bound atomic counter buffer.  This can be used by compute shaders 
-    that specify the atomic counter with the binding location ATOMIC_COUNTER_BUFFER_BINDING 
-    (from SsboBufferBindings.comp).
+    Generates the ring of atomic counters and the persistently mapped buffer that they are read 
+    back through.  The counters can be used by compute shaders that specify the atomic counter 
+    with the binding location ATOMIC_COUNTER_BUFFER_BINDING (from SsboBufferBindings.comp).
 Parameters: None
 Returns:    None
 Creator:    John Cox, 4/2017
 ------------------------------------------------------------------------------------------------*/
 PersistentAtomicCounterBuffer::PersistentAtomicCounterBuffer() :
-    _bufferId(0),
-    _bufferPtr(0)
+    _counterBufferId(0),
+    _readbackBufferId(0),
+    _readbackPtr(0),
+    _currentSlot(0),
+    _latestValue(0)
 {
     // call glBufferStorage(...) to set up an immutably-sized buffer with certain contracts 
     // Note: 
@@ -69,17 +72,34 @@ PersistentAtomicCounterBuffer::PersistentAtomicCounterBuffer() :
     // ??what is the "system" in "SYSTEM HEAP"? CPU heap or GPU heap??
     // ??why can I still read from it if I don't have GL_MAP_READ_BIT set??
 
-    glGenBuffers(1, &_bufferId);
-    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, ATOMIC_COUNTER_BUFFER_BINDING, _bufferId);
+    // Update (10/2017): The counters themselves are now in video memory (no flags, so no 
+    // mapping at all), and only the readback buffer is persistently mapped.  It needs 
+    // GL_MAP_READ_BIT, and that puts it in DMA memory, but the atomics no longer hit it.  The 
+    // GPU copies into it once per count, which is 4 bytes.
+    GLuint zeros[NUM_COUNTER_SLOTS] = { 0 };
 
-    GLuint atomicCounterResetValue = 0;
-    GLuint flags = GL_MAP_WRITE_BIT| GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
-    glBufferStorage(GL_ATOMIC_COUNTER_BUFFER, sizeof(GLuint), &atomicCounterResetValue, flags);
+    glGenBuffers(1, &_counterBufferId);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, _counterBufferId);
+    glBufferStorage(GL_ATOMIC_COUNTER_BUFFER, sizeof(zeros), zeros, 0);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+    GLuint flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &_readbackBufferId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _readbackBufferId);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, sizeof(zeros), zeros, flags);
 
     // force cast to unsigned int pointer because I know that it is a buffer of unsigned integers
-    void *voidPtr = glMapBufferRange(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), flags);
-    _bufferPtr = static_cast<unsigned int *>(voidPtr);
-    _bufferPtr[0] = 0;
+    void *voidPtr = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, sizeof(zeros), flags);
+    _readbackPtr = static_cast<unsigned int *>(voidPtr);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    for (unsigned int slot = 0; slot < NUM_COUNTER_SLOTS; slot++)
+    {
+        _slotFences[slot] = nullptr;
+    }
+
+    // start with a valid binding in case a shader uses the counter before the first reset
+    glBindBufferRange(GL_ATOMIC_COUNTER_BUFFER, ATOMIC_COUNTER_BUFFER_BINDING, _counterBufferId, 0, sizeof(GLuint));
 }
 
 /*------------------------------------------------------------------------------------------------
@@ -95,25 +115,36 @@ Creator:    John Cox, 4/2017
 ------------------------------------------------------------------------------------------------*/
 PersistentAtomicCounterBuffer::~PersistentAtomicCounterBuffer()
 {
+    for (unsigned int slot = 0; slot < NUM_COUNTER_SLOTS; slot++)
+    {
+        if (_slotFences[slot] != nullptr)
+        {
+            glDeleteSync(static_cast<GLsync>(_slotFences[slot]));
+        }
+    }
+
     // unsynchronize
-    glUnmapBuffer(GL_ATOMIC_COUNTER_BUFFER);
-    glDeleteBuffers(1, &_bufferId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _readbackBufferId);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &_readbackBufferId);
+    glDeleteBuffers(1, &_counterBufferId);
 }
 
 /*------------------------------------------------------------------------------------------------
 Description:
-    Returns a const shared pointer to a unique instance of the PersistentAtomicCounterBuffer.
+    Returns a reference to a unique instance of the PersistentAtomicCounterBuffer.
 
     If this is the first call of the program, it generates a new instance.
 
-    Note: Returning a const reference to a const shared pointer because I don't want the class' 
-    instance pointer being messed with on the outside.
+    Note: This used to be a const reference, but the ring of counters keeps track of which one 
+    is in use, so the instance changes when it is used.
 Parameters: None
 Returns:    
-    A const reference to a const shared pointer of the class instance.  
+    A reference to the class instance.  
 Creator:    John Cox, 4/2017
 ------------------------------------------------------------------------------------------------*/
-const PersistentAtomicCounterBuffer& PersistentAtomicCounterBuffer::GetInstance()
+PersistentAtomicCounterBuffer& PersistentAtomicCounterBuffer::GetInstance()
 {
     // it is okay to make this static initializer because the static value will not be 
     // initialized until the first call to this method (unlike static globals, which are 
@@ -125,71 +156,94 @@ const PersistentAtomicCounterBuffer& PersistentAtomicCounterBuffer::GetInstance(
 
 /*------------------------------------------------------------------------------------------------
 Description:
-    Waits for the GPU to finish whatever it is doing, then puts a 0 into the atomic counter 
-    buffer.  Because of GL_MAP_WRITE_BIT and GL_MAP_COHERENT_BIT, this 0 will become immediately 
-    visible to GPU.
-    
-    Note: I discovered after much frustration that you should NOT do this:
-    - fence
-    - _bufferPtr[0] = 0
-    - client wait sync (wait for GPU to finish)
-
-    That just doesn't work.  Must do this:
-    - fence
-    - client wait sync (wait for GPU to finish)
-    - _bufferPtr[0] = 0
-
-    The wait for GPU to finish seems to be pretty much nonexistent on my hardware and for this 
-    implementation.
+    Moves on to the next counter in the ring, clears it to 0 on the GPU, and binds it to 
+    ATOMIC_COUNTER_BUFFER_BINDING.  The clear is just another GL command, so it happens after 
+    anything that was already queued and the CPU doesn't wait for any of it.
+
+    Note: If that counter's last readback hasn't finished yet, then it is dropped.  The GPU 
+    still does the copy before the clear because the commands run in order, so nothing gets 
+    mixed up.  GetCounterValue() just won't see it.
+
+    Also Note: This used to fence, wait for the fence, and then write a 0 through the 
+    persistent pointer (and I discovered after much frustration that the wait had to come 
+    before the write).  That was a stall on every call.
 Parameters: None
 Returns:    None
 Creator:    John Cox, 4/2017
 ------------------------------------------------------------------------------------------------*/
-void PersistentAtomicCounterBuffer::ResetCounter() const
+void PersistentAtomicCounterBuffer::ResetCounter()
 {
-    GLsync writeSyncFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-
-    // Note: Thanks to this article for the idea for the wait sync loop.
-    // https://www.codeproject.com/Articles/872417/Persistent-Mapped-Buffers-in-OpenGL
-    GLenum waitReturn = GL_UNSIGNALED;
-    while (waitReturn != GL_ALREADY_SIGNALED && waitReturn != GL_CONDITION_SATISFIED)
+    _currentSlot = (_currentSlot + 1) % NUM_COUNTER_SLOTS;
+    if (_slotFences[_currentSlot] != nullptr)
     {
-        waitReturn = glClientWaitSync(writeSyncFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1);
+        glDeleteSync(static_cast<GLsync>(_slotFences[_currentSlot]));
+        _slotFences[_currentSlot] = nullptr;
     }
-    _bufferPtr[0] = 0;
 
-    // if it has already synchronized (it has to be in order to reach this point), then the sync 
-    // object will be immediately deleted and there should be no performance problem
-    // Note: See https://www.khronos.org/opengl/wiki/GLAPI/glDeleteSync.
-    glDeleteSync(writeSyncFence);
+    GLuint zero = 0;
+    GLintptr offsetBytes = _currentSlot * sizeof(GLuint);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, _counterBufferId);
+    glClearBufferSubData(GL_ATOMIC_COUNTER_BUFFER, GL_R32UI, offsetBytes, sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+    // the shaders use offset 0, so bind just this counter
+    glBindBufferRange(GL_ATOMIC_COUNTER_BUFFER, ATOMIC_COUNTER_BUFFER_BINDING, _counterBufferId, offsetBytes, sizeof(GLuint));
 }
 
 /*------------------------------------------------------------------------------------------------
 Description:
-    Waits for the GPU to finish whatever it is doing, then reads the atomic counter value.
+    Queues a GPU copy of the current counter into the readback buffer and puts down a fence 
+    after it.  Call this after the shaders that use the counter have been dispatched.
 
-    Like with ResetCounter, the wait for GPU to finish seems to be pretty much nonexistent on my 
-    hardware and for this implementation.
+    Note: The caller must have issued a GL_BUFFER_UPDATE_BARRIER_BIT memory barrier after 
+    those shaders so that the copy sees their atomic writes.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void PersistentAtomicCounterBuffer::QueueCounterReadback()
+{
+    GLintptr offsetBytes = _currentSlot * sizeof(GLuint);
+    glBindBuffer(GL_COPY_READ_BUFFER, _counterBufferId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _readbackBufferId);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offsetBytes, offsetBytes, sizeof(GLuint));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    _slotFences[_currentSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
 
-    ??why can I still read from it if I don't have GL_MAP_READ_BIT set??
-    
-    Note: Failure to call glMemoryBarrier(...) with GL_ATOMIC_COUNTER_BARRIER_BIT doesn't seem 
-    to make this not work.  I can read the value regardless.  I don't know why.
+/*------------------------------------------------------------------------------------------------
+Description:
+    Returns the newest counter value that the GPU has finished copying back.  Checks the ring 
+    from newest to oldest without waiting (a timeout of 0), and if none of them are done, then 
+    the last value that was found is returned again.
 
+    Note: The readback buffer is coherent, so once the fence has signaled, the value is 
+    visible through the pointer.
 Parameters: None
-Returns:    None
+Returns:    
+    A counter value from up to NUM_COUNTER_SLOTS resets ago.
 Creator:    John Cox, 4/2017
 ------------------------------------------------------------------------------------------------*/
-unsigned int PersistentAtomicCounterBuffer::GetCounterValue() const
+unsigned int PersistentAtomicCounterBuffer::GetCounterValue()
 {
-    GLsync readSyncFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-    GLenum waitReturn = GL_UNSIGNALED;
-    while (waitReturn != GL_ALREADY_SIGNALED && waitReturn != GL_CONDITION_SATISFIED)
+    for (unsigned int age = 0; age < NUM_COUNTER_SLOTS; age++)
     {
-        waitReturn = glClientWaitSync(readSyncFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1);
+        unsigned int slot = (_currentSlot + NUM_COUNTER_SLOTS - age) % NUM_COUNTER_SLOTS;
+        if (_slotFences[slot] == nullptr)
+        {
+            continue;
+        }
+
+        // Note: Flush on the first check so that the fence is guaranteed to signal eventually.
+        GLenum waitReturn = glClientWaitSync(static_cast<GLsync>(_slotFences[slot]), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (waitReturn == GL_ALREADY_SIGNALED || waitReturn == GL_CONDITION_SATISFIED)
+        {
+            _latestValue = _readbackPtr[slot];
+            break;
+        }
     }
-    glDeleteSync(readSyncFence);
 
-    return *_bufferPtr;
+    return _latestValue;
 }
-
@@ -0,0 +1,71 @@
+#include "Include/Buffers/SSBOs/ParticleEmitterSsbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
+
+// the emitter count is padded out to 16 bytes (see ParticleEmitterBuffer.comp)
+static const unsigned int NUM_HEADER_UINTS = 4;
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then allocates space for the SSBO.  It starts out with no emitters.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleEmitterSsbo::ParticleEmitterSsbo() :
+    SsboBase(),  // generate buffers
+    _capacity(0)
+{
+    unsigned int header[NUM_HEADER_UINTS] = { 0, 0, 0, 0 };
+
+    // now bind this new buffer to the dedicated buffer binding location
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_EMITTER_BUFFER_BINDING, _bufferId);
+
+    // and fill it with new data
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(header), header, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    There are no size uniforms for this buffer.  The emitter count is in the buffer itself 
+    because it can change from frame to frame.
+Parameters: 
+    computeProgramId    Unused.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleEmitterSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Copies the emitters into the buffer.  If there are more of them than there is room for, 
+    then the buffer is reallocated first.
+
+    Note: The buffer stays bound to its binding location after reallocating.  
+    glBindBufferBase(...) binds the buffer object, not its storage.
+Parameters: 
+    emitters    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleEmitterSsbo::Upload(const std::vector<ParticleEmitterDescriptor> &emitters)
+{
+    unsigned int numEmitters = static_cast<unsigned int>(emitters.size());
+    unsigned int header[NUM_HEADER_UINTS] = { numEmitters, 0, 0, 0 };
+    unsigned int emittersSizeBytes = numEmitters * sizeof(ParticleEmitterDescriptor);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    if (numEmitters > _capacity)
+    {
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(header) + emittersSizeBytes, nullptr, GL_DYNAMIC_DRAW);
+        _capacity = numEmitters;
+    }
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), header);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(header), emittersSizeBytes, emitters.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
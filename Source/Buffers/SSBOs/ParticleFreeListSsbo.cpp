@@ -0,0 +1,74 @@
+#include "Include/Buffers/SSBOs/ParticleFreeListSsbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
+
+#include <vector>
+
+// the stack's header is 6 uints (see ParticleFreeListBuffer.comp)
+static const unsigned int NUM_HEADER_UINTS = 6;
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then allocates space for the SSBO and puts every particle's index 
+    on the stack.  The particles all start out inactive (see ParticleSsbo).
+
+    Note: The indices go on in reverse order, the same as RebuildParticleFreeList.comp puts 
+    them, so that the first particle is on top.
+Parameters: 
+    numParticles    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleFreeListSsbo::ParticleFreeListSsbo(unsigned int numParticles) :
+    SsboBase()  // generate buffers
+{
+    std::vector<unsigned int> v(NUM_HEADER_UINTS + numParticles);
+
+    // number of slots, then nothing to emit yet
+    v[0] = numParticles;
+    v[1] = 0;
+    v[2] = 0;
+    v[3] = 0;
+    v[4] = 1;
+    v[5] = 1;
+    for (unsigned int slotIndex = 0; slotIndex < numParticles; slotIndex++)
+    {
+        v[NUM_HEADER_UINTS + slotIndex] = numParticles - 1 - slotIndex;
+    }
+
+    // now bind this new buffer to the dedicated buffer binding location
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_FREE_LIST_BUFFER_BINDING, _bufferId);
+
+    // and fill it with new data
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(unsigned int), v.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    There are no size uniforms for this buffer.  It has room for every particle, and the 
+    shaders that use it already have uMaxNumParticles.
+Parameters: 
+    computeProgramId    Unused.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleFreeListSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Where the glDispatchComputeIndirect(...) arguments are in the buffer.  They come after the 
+    "number of slots", "number to emit", and "emit start" uints.
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleFreeListSsbo::IndirectDispatchOffsetBytes()
+{
+    return 3 * sizeof(unsigned int);
+}
@@ -0,0 +1,167 @@
+#include "Include/Buffers/SSBOs/ParticleMaxSpeedSsbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then allocates space for the SSBO.  It's only a single uint.
+
+    Also generates the persistently mapped buffer that the value is read back through, with 
+    one float for each slot in the ring.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleMaxSpeedSsbo::ParticleMaxSpeedSsbo() :
+    SsboBase(),  // generate buffers
+    _readbackBufferId(0),
+    _readbackPtr(0),
+    _currentSlot(0),
+    _latestMaxSpeedInRadiiSqr(0.0f)
+{
+    unsigned int maxSpeedInRadiiSqrBits = 0;
+
+    // now bind this new buffer to the dedicated buffer binding location
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_MAX_SPEED_BUFFER_BINDING, _bufferId);
+
+    // and fill it with new data
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(maxSpeedInRadiiSqrBits), &maxSpeedInRadiiSqrBits, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Note: See the PersistentAtomicCounterBuffer constructor for why these flags.
+    float zeros[NUM_READBACK_SLOTS] = { 0.0f };
+    GLuint flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &_readbackBufferId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _readbackBufferId);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, sizeof(zeros), zeros, flags);
+    void *voidPtr = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, sizeof(zeros), flags);
+    _readbackPtr = static_cast<float *>(voidPtr);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    for (unsigned int slot = 0; slot < NUM_READBACK_SLOTS; slot++)
+    {
+        _slotFences[slot] = nullptr;
+    }
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Cleans up the fences and the readback buffer.  The base class deletes the SSBO.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleMaxSpeedSsbo::~ParticleMaxSpeedSsbo()
+{
+    for (unsigned int slot = 0; slot < NUM_READBACK_SLOTS; slot++)
+    {
+        if (_slotFences[slot] != nullptr)
+        {
+            glDeleteSync(static_cast<GLsync>(_slotFences[slot]));
+        }
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _readbackBufferId);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &_readbackBufferId);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    There are no size uniforms for this buffer.  It's a single value.
+Parameters: 
+    computeProgramId    Unused.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleMaxSpeedSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Sets the maximum back to 0 so that MeasureMaxParticleSpeed.comp can start over.  The clear 
+    is just another GL command, so the CPU doesn't wait for anything.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleMaxSpeedSsbo::Reset() const
+{
+    GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(zero), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Moves on to the next slot in the ring, queues a GPU copy of the maximum into it, and puts 
+    down a fence after the copy.  Call this after MeasureMaxParticleSpeed.comp.
+
+    Note: The caller must have issued a GL_BUFFER_UPDATE_BARRIER_BIT memory barrier after the 
+    shader that wrote the value so that the copy sees it.
+
+    Also Note: If that slot's last copy hasn't finished yet, then it is dropped.  The GPU still 
+    runs the commands in order, so GetMaxSpeedInRadiiSqr() just won't see it.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleMaxSpeedSsbo::QueueReadback()
+{
+    _currentSlot = (_currentSlot + 1) % NUM_READBACK_SLOTS;
+    if (_slotFences[_currentSlot] != nullptr)
+    {
+        glDeleteSync(static_cast<GLsync>(_slotFences[_currentSlot]));
+        _slotFences[_currentSlot] = nullptr;
+    }
+
+    GLintptr offsetBytes = _currentSlot * sizeof(float);
+    glBindBuffer(GL_COPY_READ_BUFFER, _bufferId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _readbackBufferId);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, offsetBytes, sizeof(float));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    _slotFences[_currentSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Returns the largest squared "radii per second" from the newest readback that the GPU has 
+    finished.  Checks the ring from newest to oldest without waiting (a timeout of 0), and if 
+    none of them are done, then the last value that was found is returned again.
+
+    Note: The shader wrote the float's bit pattern into a uint, and the copy kept the bits, so 
+    the readback buffer can be read straight as floats.
+Parameters: None
+Returns:    
+    See Description.  0 until the first readback finishes.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+float ParticleMaxSpeedSsbo::GetMaxSpeedInRadiiSqr()
+{
+    for (unsigned int age = 0; age < NUM_READBACK_SLOTS; age++)
+    {
+        unsigned int slot = (_currentSlot + NUM_READBACK_SLOTS - age) % NUM_READBACK_SLOTS;
+        if (_slotFences[slot] == nullptr)
+        {
+            continue;
+        }
+
+        // Note: Flush on the first check so that the fence is guaranteed to signal eventually.
+        GLenum waitReturn = glClientWaitSync(static_cast<GLsync>(_slotFences[slot]), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (waitReturn == GL_ALREADY_SIGNALED || waitReturn == GL_CONDITION_SATISFIED)
+        {
+            _latestMaxSpeedInRadiiSqr = _readbackPtr[slot];
+            break;
+        }
+    }
+
+    return _latestMaxSpeedInRadiiSqr;
+}
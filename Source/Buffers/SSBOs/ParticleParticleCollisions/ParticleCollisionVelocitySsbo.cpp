@@ -0,0 +1,102 @@
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleCollisionVelocitySsbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
+#include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/ShaderStorage.h"
+
+#include "ThirdParty/glm/vec2.hpp"
+
+#include <utility>
+#include <vector>
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then generates the second buffer and allocates space for both.
+
+    Note: Each velocity is a vec2 (this is a 2D demo), and there is no reason to make a C++
+    struct for something that the CPU never looks at.
+Parameters:
+    numParticles    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleCollisionVelocitySsbo::ParticleCollisionVelocitySsbo(unsigned int numParticles) :
+    SsboBase(),  // generate buffers
+    _writeBufferId(0),
+    _numItems(numParticles)
+{
+    glGenBuffers(1, &_writeBufferId);
+
+    std::vector<glm::vec2> v(numParticles);
+    unsigned int bufferIds[] = { _bufferId, _writeBufferId };
+    for (unsigned int bufferId : bufferIds)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferId);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(glm::vec2), v.data(), GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // now bind these new buffers to the dedicated buffer binding locations
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_COLLISION_VELOCITY_READ_BUFFER_BINDING, _bufferId);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_COLLISION_VELOCITY_WRITE_BUFFER_BINDING, _writeBufferId);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    SsboBase cleans up the first buffer.  This cleans up the second.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleCollisionVelocitySsbo::~ParticleCollisionVelocitySsbo()
+{
+    glDeleteBuffers(1, &_writeBufferId);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Defines the buffer's size uniform in the specified shader.
+Parameters:
+    computeProgramId    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleCollisionVelocitySsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+    ShaderStorage &shaderStorageRef = ShaderStorage::GetInstance();
+    unsigned int bufferSizeUnifLoc = shaderStorageRef.GetUniformLocation(computeProgramId, "uParticleCollisionVelocityBufferSize");
+
+    // the uniform should remain constant after this
+    glUseProgram(computeProgramId);
+    glUniform1ui(bufferSizeUnifLoc, _numItems);
+    glUseProgram(0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A simple getter for the value that was passed in on creation.
+Parameters: None
+Returns:
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleCollisionVelocitySsbo::NumItems() const
+{
+    return _numItems;
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    The buffer that was just written becomes the one that is read, and the other one will be
+    written next.  No data moves.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleCollisionVelocitySsbo::Swap()
+{
+    std::swap(_bufferId, _writeBufferId);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_COLLISION_VELOCITY_READ_BUFFER_BINDING, _bufferId);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_COLLISION_VELOCITY_WRITE_BUFFER_BINDING, _writeBufferId);
+}
@@ -1,35 +1,39 @@
-#include "Include/Buffers/SSBOs/ParticleParticleCollisions/PotentialParticleParticleCollisionsSsbo.h"
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleContactSsbo.h"
 
 #include "ThirdParty/glload/include/glload/gl_4_4.h"
 #include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
 #include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/Compute/Collisions/MaxNumPotentialCollisions.comp"
 #include "Shaders/ShaderStorage.h"
 
-#include "Include/Buffers/PotentialParticleCollisions.h"
-
 #include <vector>
 
 /*------------------------------------------------------------------------------------------------
 Description:
     Initializes base class, then gives derived class members initial values and allocates space 
     for the SSBO.
+
+    Note: Each ParticleContacts is MAX_NUM_POTENTIAL_COLLISIONS neighbour indexes, 
+    MAX_NUM_POTENTIAL_COLLISIONS lambdas, a contact count, and a colour.  Those are all 4-byte 
+    ints and floats, and there is no reason to make a C++ struct for something that the CPU 
+    never looks at.
 Parameters: 
     numParticles    Self-explanatory.
 Returns:    None
-Creator:    John Cox, 5/2017
+Creator:    John Cox, 10/2017
 ------------------------------------------------------------------------------------------------*/
-PotentialParticleParticleCollisionsSsbo::PotentialParticleParticleCollisionsSsbo(unsigned int numParticles) :
+ParticleContactSsbo::ParticleContactSsbo(unsigned int numParticles) :
     SsboBase(),  // generate buffers
     _numItems(numParticles)
 {
-    std::vector<PotentialParticleCollisions> v(numParticles);
+    std::vector<int> v(numParticles * ((MAX_NUM_POTENTIAL_COLLISIONS * 2) + 2));
 
     // now bind this new buffer to the dedicated buffer binding location
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, POTENTIAL_PARTICLE_PARTICLE_COLLISIONS_BUFFER_BINDING, _bufferId);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_CONTACT_BUFFER_BINDING, _bufferId);
 
     // and fill it with new data
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(PotentialParticleCollisions), v.data(), GL_DYNAMIC_DRAW);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(int), v.data(), GL_DYNAMIC_DRAW);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
 
@@ -39,12 +43,12 @@ Description:
 Parameters: 
     computeProgramId    Self-explanatory.
 Returns:    None
-Creator:    John Cox, 6/2017
+Creator:    John Cox, 10/2017
 ------------------------------------------------------------------------------------------------*/
-void PotentialParticleParticleCollisionsSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+void ParticleContactSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
 {
     ShaderStorage &shaderStorageRef = ShaderStorage::GetInstance();
-    unsigned int bufferSizeUnifLoc = shaderStorageRef.GetUniformLocation(computeProgramId, "uPotentialParticleParticleCollisionsBufferSize");
+    unsigned int bufferSizeUnifLoc = shaderStorageRef.GetUniformLocation(computeProgramId, "uParticleContactBufferSize");
 
     // the uniform should remain constant after this 
     glUseProgram(computeProgramId);
@@ -58,9 +62,9 @@ Description:
 Parameters: None
 Returns:    
     See Description.
-Creator:    John Cox, 6/2017
+Creator:    John Cox, 10/2017
 ------------------------------------------------------------------------------------------------*/
-unsigned int PotentialParticleParticleCollisionsSsbo::NumItems() const
+unsigned int ParticleContactSsbo::NumItems() const
 {
     return _numItems;
 }
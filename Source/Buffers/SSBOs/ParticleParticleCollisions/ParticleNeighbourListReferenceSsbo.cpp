@@ -0,0 +1,203 @@
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleNeighbourListReferenceSsbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
+#include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/ShaderStorage.h"
+
+#include "ThirdParty/glm/vec4.hpp"
+
+#include <vector>
+
+// the header is 19 uints, and std430 puts the vec4 array after it on the next 16-byte boundary 
+// (see ParticleNeighbourListReferenceBuffer.comp)
+static const unsigned int NUM_HEADER_UINTS = 19;
+static const unsigned int NUM_HEADER_VEC4S = 5;
+
+// where each set of glDispatchComputeIndirect(...) arguments starts in the header
+static const unsigned int REBUILD_DISPATCH_UINT_INDEX = 2;
+static const unsigned int REBUILD_PREFIX_SCAN_DISPATCH_UINT_INDEX = 5;
+static const unsigned int REBUILD_SINGLE_WORK_GROUP_DISPATCH_UINT_INDEX = 8;
+static const unsigned int PHYSICAL_SORT_DISPATCH_UINT_INDEX = 11;
+static const unsigned int INDEX_SORT_DISPATCH_UINT_INDEX = 14;
+
+// how often DecideNeighbourListRebuild.comp has run and how often it chose to rebuild
+static const unsigned int NUM_DECISIONS_UINT_INDEX = 17;
+static const unsigned int NUM_REBUILDS_UINT_INDEX = 18;
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then gives derived class members initial values and allocates space 
+    for the SSBO.
+
+    Note: The GPU-side buffer starts with a 19-uint header (the max displacement, the physical 
+    sort counter, 5 sets of indirect dispatch arguments, and the rebuild counts) followed by an 
+    array of vec4s.  
+    std430 aligns that array to 16 bytes, so the header takes up 5 vec4s' worth of space.  All 
+    0s means "every particle was inactive at the last rebuild", so the first active particle 
+    will force the BVH to be built.  The dispatch arguments start at 0 work groups.
+Parameters: 
+    numParticles    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleNeighbourListReferenceSsbo::ParticleNeighbourListReferenceSsbo(unsigned int numParticles) :
+    SsboBase(),  // generate buffers
+    _numItems(numParticles)
+{
+    std::vector<glm::vec4> v(numParticles + NUM_HEADER_VEC4S);
+
+    // Y and Z of each set of dispatch arguments must be 1 even when X is 0
+    unsigned int *header = reinterpret_cast<unsigned int *>(v.data());
+    unsigned int dispatchIndexes[] = 
+    {
+        REBUILD_DISPATCH_UINT_INDEX,
+        REBUILD_PREFIX_SCAN_DISPATCH_UINT_INDEX,
+        REBUILD_SINGLE_WORK_GROUP_DISPATCH_UINT_INDEX,
+        PHYSICAL_SORT_DISPATCH_UINT_INDEX,
+        INDEX_SORT_DISPATCH_UINT_INDEX
+    };
+    for (unsigned int dispatchIndex : dispatchIndexes)
+    {
+        header[dispatchIndex + 1] = 1;
+        header[dispatchIndex + 2] = 1;
+    }
+    static_assert((NUM_HEADER_UINTS * sizeof(unsigned int)) <= (NUM_HEADER_VEC4S * sizeof(glm::vec4)), 
+        "neighbour list reference header doesn't fit");
+
+    // now bind this new buffer to the dedicated buffer binding location
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_NEIGHBOUR_LIST_REFERENCE_BUFFER_BINDING, _bufferId);
+
+    // and fill it with new data
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(glm::vec4), v.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Defines the buffer's size uniform in the specified shader.  
+Parameters: 
+    computeProgramId    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleNeighbourListReferenceSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+    ShaderStorage &shaderStorageRef = ShaderStorage::GetInstance();
+    unsigned int bufferSizeUnifLoc = shaderStorageRef.GetUniformLocation(computeProgramId, "uParticleNeighbourListReferenceBufferSize");
+
+    // the uniform should remain constant after this 
+    glUseProgram(computeProgramId);
+    glUniform1ui(bufferSizeUnifLoc, _numItems);
+    glUseProgram(0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A simple getter for the value that was passed in on creation.
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleNeighbourListReferenceSsbo::NumItems() const
+{
+    return _numItems;
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Where the glDispatchComputeIndirect(...) arguments for the sorting and BVH shaders that run 
+    1 thread per particle are in the buffer.  0 work groups if the BVH is still good.
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleNeighbourListReferenceSsbo::RebuildDispatchOffsetBytes()
+{
+    return REBUILD_DISPATCH_UINT_INDEX * sizeof(unsigned int);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Like RebuildDispatchOffsetBytes(), but for the prefix scan's 1st and 3rd stages, which work 
+    on 2 items per thread.
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleNeighbourListReferenceSsbo::RebuildPrefixScanDispatchOffsetBytes()
+{
+    return REBUILD_PREFIX_SCAN_DISPATCH_UINT_INDEX * sizeof(unsigned int);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Like RebuildDispatchOffsetBytes(), but for the prefix scan's 2nd stage, which is 1 work 
+    group.
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleNeighbourListReferenceSsbo::RebuildSingleWorkGroupDispatchOffsetBytes()
+{
+    return REBUILD_SINGLE_WORK_GROUP_DISPATCH_UINT_INDEX * sizeof(unsigned int);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Like RebuildDispatchOffsetBytes(), but only non-zero if this rebuild physically sorts the 
+    particles (see ParticleIndexSort.comp).
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleNeighbourListReferenceSsbo::PhysicalSortDispatchOffsetBytes()
+{
+    return PHYSICAL_SORT_DISPATCH_UINT_INDEX * sizeof(unsigned int);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Like RebuildDispatchOffsetBytes(), but only non-zero if this rebuild only sorts the 
+    particles' indexes (see ParticleIndexSort.comp).
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleNeighbourListReferenceSsbo::IndexSortDispatchOffsetBytes()
+{
+    return INDEX_SORT_DISPATCH_UINT_INDEX * sizeof(unsigned int);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Reads back how many times DecideNeighbourListRebuild.comp has run and how many of those 
+    times it chose to rebuild the BVH.  The difference is how many rebuilds the skin saved (see 
+    NeighbourListSkin.comp).
+
+    Note: This waits for the GPU to catch up, so don't call it every frame.
+Parameters: 
+    numDecisions    Out.  Self-explanatory.
+    numRebuilds     Out.  Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleNeighbourListReferenceSsbo::ReadRebuildCounts(unsigned int &numDecisions, unsigned int &numRebuilds) const
+{
+    unsigned int counts[2] = { 0, 0 };
+    static_assert(NUM_REBUILDS_UINT_INDEX == NUM_DECISIONS_UINT_INDEX + 1, "rebuild counts must be next to each other");
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, NUM_DECISIONS_UINT_INDEX * sizeof(unsigned int), sizeof(counts), counts);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    numDecisions = counts[0];
+    numRebuilds = counts[1];
+}
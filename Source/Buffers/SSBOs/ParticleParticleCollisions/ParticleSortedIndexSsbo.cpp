@@ -0,0 +1,47 @@
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleSortedIndexSsbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
+
+#include <vector>
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then allocates space for the SSBO and fills it 1-to-1 (leaf i is
+    particle i).  That is the right order until the first sort, and the particles all start
+    out inactive anyway (see ParticleSsbo).
+Parameters:
+    numParticles    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleSortedIndexSsbo::ParticleSortedIndexSsbo(unsigned int numParticles) :
+    SsboBase()  // generate buffers
+{
+    std::vector<unsigned int> v(numParticles);
+    for (unsigned int leafIndex = 0; leafIndex < numParticles; leafIndex++)
+    {
+        v[leafIndex] = leafIndex;
+    }
+
+    // now bind this new buffer to the dedicated buffer binding location
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_SORTED_INDEX_BUFFER_BINDING, _bufferId);
+
+    // and fill it with new data
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(unsigned int), v.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    There are no size uniforms for this buffer.  It has one entry for every particle, and the
+    shaders that use it already have uMaxNumParticles or uMaxNumParticleSortingData.
+Parameters:
+    computeProgramId    Unused.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleSortedIndexSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+}
@@ -0,0 +1,47 @@
+#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticleSweptBoxSsbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
+
+#include <vector>
+
+// a BoundingBox (4 floats) and a vec2 (see ParticleSweptBoxBuffer.comp)
+static const unsigned int NUM_FLOATS_PER_SWEPT_BOX = 6;
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then allocates space for the SSBO.
+
+    Note: ParticleUpdate.comp writes every particle's box before anything reads them, and there
+    is no reason to make a C++ struct for something that the CPU never looks at.
+Parameters:
+    numParticles    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleSweptBoxSsbo::ParticleSweptBoxSsbo(unsigned int numParticles) :
+    SsboBase()  // generate buffers
+{
+    std::vector<float> v(numParticles * NUM_FLOATS_PER_SWEPT_BOX);
+
+    // now bind this new buffer to the dedicated buffer binding location
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_SWEPT_BOX_BUFFER_BINDING, _bufferId);
+
+    // and fill it with new data
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(float), v.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    There are no size uniforms for this buffer.  It has one entry for every particle, and the
+    shaders that use it already have uMaxNumParticles.
+Parameters:
+    computeProgramId    Unused.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleSweptBoxSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+}
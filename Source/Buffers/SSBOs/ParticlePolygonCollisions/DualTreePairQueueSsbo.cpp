@@ -0,0 +1,117 @@
+#include "Include/Buffers/SSBOs/ParticlePolygonCollisions/DualTreePairQueueSsbo.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
+#include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/Compute/Collisions/ParticlePolygon/DualTree/ParticlePolygonDualTree.comp"
+#include "Shaders/ShaderStorage.h"
+
+#include <vector>
+
+// the queue's header is 6 uints (see DualTreePairQueueBuffer.comp)
+static const unsigned int NUM_HEADER_UINTS = 6;
+
+// each pair is 2 ints
+static const unsigned int NUM_INTS_PER_PAIR = 2;
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Initializes base class, then gives derived class members initial values and allocates space 
+    for the SSBO.
+
+    Note: The header is 24 bytes and the pairs are 8 bytes each, so std430 puts the first pair 
+    right after the header (see DualTreePairQueueBuffer.comp).  There are two halves of pairs, 
+    one for reading and one for writing.
+Parameters: 
+    numParticles    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+DualTreePairQueueSsbo::DualTreePairQueueSsbo(unsigned int numParticles) :
+    SsboBase(),  // generate buffers
+    _halfSize(numParticles * DUAL_TREE_PAIR_QUEUE_PAIRS_PER_PARTICLE)
+{
+    std::vector<int> v(NUM_HEADER_UINTS + (_halfSize * 2 * NUM_INTS_PER_PAIR));
+
+    // now bind this new buffer to the dedicated buffer binding location
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DUAL_TREE_PAIR_QUEUE_BUFFER_BINDING, _bufferId);
+
+    // and fill it with new data
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(int), v.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Defines the buffer's size uniform in the specified shader.  
+Parameters: 
+    computeProgramId    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void DualTreePairQueueSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+{
+    ShaderStorage &shaderStorageRef = ShaderStorage::GetInstance();
+    unsigned int bufferSizeUnifLoc = shaderStorageRef.GetUniformLocation(computeProgramId, "uDualTreePairQueueHalfSize");
+
+    // the uniform should remain constant after this 
+    glUseProgram(computeProgramId);
+    glUniform1ui(bufferSizeUnifLoc, _halfSize);
+    glUseProgram(0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Sets up the queue for a new frame's traversal.  The root pair is put at the start of the 
+    first half and the header says that one pair was "written", so the first 
+    PrepareDualTreePass.comp will have the first pass read it.  The overflow flag is cleared.
+
+    Note: This is 32 bytes with glBufferSubData(...), so it's cheap.  It is ordered with the 
+    dispatches around it like any other GL command.
+Parameters: 
+    particleRootNodeIndex   Self-explanatory.
+    polygonRootNodeIndex    Self-explanatory.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void DualTreePairQueueSsbo::StartWithRootPair(int particleRootNodeIndex, int polygonRootNodeIndex) const
+{
+    // to expand, expanded, overflowed, and the (unused until prepared) dispatch size
+    int start[NUM_HEADER_UINTS + NUM_INTS_PER_PAIR] = 
+    {
+        0, 1, 0, 0, 1, 1,
+        particleRootNodeIndex, polygonRootNodeIndex
+    };
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(start), start);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A simple getter for the value that was determined on creation.
+Parameters: None
+Returns:    
+    The number of pairs in each half of the queue.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int DualTreePairQueueSsbo::HalfSize() const
+{
+    return _halfSize;
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Where the glDispatchComputeIndirect(...) arguments are in the buffer.  They come after the 
+    "to expand", "expanded", and "overflowed" uints.
+Parameters: None
+Returns:    
+    See Description.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int DualTreePairQueueSsbo::IndirectDispatchOffsetBytes()
+{
+    return 3 * sizeof(unsigned int);
+}
@@ -1,12 +1,11 @@
-#include "Include/Buffers/SSBOs/ParticlePolygonCollisions/PotentialParticlePolygonCollisionsSsbo.h"
+#include "Include/Buffers/SSBOs/ParticlePolygonCollisions/ParticlePolygonCandidateSsbo.h"
 
 #include "ThirdParty/glload/include/glload/gl_4_4.h"
 #include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
 #include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/Compute/Collisions/MaxNumPotentialCollisions.comp"
 #include "Shaders/ShaderStorage.h"
 
-#include "Include/Buffers/PotentialParticleCollisions.h"
-
 #include <vector>
 
 /*------------------------------------------------------------------------------------------------
@@ -14,29 +13,26 @@ Description:
     Initializes base class, then gives derived class members initial values and allocates space 
     for the SSBO.
 
-    Note: This is identical to 
-    SSBOs/ParticleParticleCollisions/PotentialParticleParticleCollisionsSsbo, but this one is 
-    contained by the ParticlePolygonCollisions shader controller instead of the 
-    ParticleParticleCollisions shader controller, and all buffers must be unique (under my 
-    current design of hard-coding SSBO buffer binding locations), so the potential 
-    particle-polygon collisions buffer needs a different SSBO.
+    Note: Each ParticlePolygonCandidates is MAX_NUM_POTENTIAL_COLLISIONS polygon indexes and a 
+    count, all 4-byte ints, and there is no reason to make a C++ struct for something that the 
+    CPU never looks at.  The counts must start at 0.
 Parameters: 
     numParticles    Self-explanatory.
 Returns:    None
-Creator:    John Cox, 7/2017
+Creator:    John Cox, 10/2017
 ------------------------------------------------------------------------------------------------*/
-PotentialParticlePolygonCollisionsSsbo::PotentialParticlePolygonCollisionsSsbo(unsigned int numParticles) :
+ParticlePolygonCandidateSsbo::ParticlePolygonCandidateSsbo(unsigned int numParticles) :
     SsboBase(),  // generate buffers
     _numItems(numParticles)
 {
-    std::vector<PotentialParticleCollisions> v(numParticles);
+    std::vector<int> v(numParticles * (MAX_NUM_POTENTIAL_COLLISIONS + 1));
 
     // now bind this new buffer to the dedicated buffer binding location
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, POTENTIAL_PARTICLE_POLYGON_COLLISIONS_BUFFER_BINDING, _bufferId);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_POLYGON_CANDIDATE_BUFFER_BINDING, _bufferId);
 
     // and fill it with new data
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(PotentialParticleCollisions), v.data(), GL_DYNAMIC_DRAW);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(int), v.data(), GL_DYNAMIC_DRAW);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
 
@@ -46,12 +42,12 @@ Description:
 Parameters: 
     computeProgramId    Self-explanatory.
 Returns:    None
-Creator:    John Cox, 7/2017
+Creator:    John Cox, 10/2017
 ------------------------------------------------------------------------------------------------*/
-void PotentialParticlePolygonCollisionsSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
+void ParticlePolygonCandidateSsbo::ConfigureConstantUniforms(unsigned int computeProgramId) const
 {
     ShaderStorage &shaderStorageRef = ShaderStorage::GetInstance();
-    unsigned int bufferSizeUnifLoc = shaderStorageRef.GetUniformLocation(computeProgramId, "uPotentialParticlePolygonCollisionsBufferSize");
+    unsigned int bufferSizeUnifLoc = shaderStorageRef.GetUniformLocation(computeProgramId, "uParticlePolygonCandidateBufferSize");
 
     // the uniform should remain constant after this 
     glUseProgram(computeProgramId);
@@ -65,9 +61,9 @@ Description:
 Parameters: None
 Returns:    
     See Description.
-Creator:    John Cox, 6/2017
+Creator:    John Cox, 10/2017
 ------------------------------------------------------------------------------------------------*/
-unsigned int PotentialParticlePolygonCollisionsSsbo::NumItems() const
+unsigned int ParticlePolygonCandidateSsbo::NumItems() const
 {
     return _numItems;
 }
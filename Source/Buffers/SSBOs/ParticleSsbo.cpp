@@ -1,55 +1,39 @@
 #include "Include/Buffers/SSBOs/ParticleSsbo.h"
 
 #include <vector>
-#include <random>   // for generating initial data
-#include <time.h>
+#include <cstddef>  // for offsetof
 
 #include "ThirdParty/glload/include/glload/gl_4_4.h"
+#include "ThirdParty/glm/vec2.hpp"
 #include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
 #include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/Compute/ParticleLayout.comp"
+#include "Shaders/Compute/Collisions/ParticleParticle/Sorting/ParticleIndexSort.comp"
 #include "Shaders/ShaderStorage.h"
 
 #include "Include/Buffers/Particle.h"
+#include "Include/Buffers/CompactParticle.h"
 
 
 /*------------------------------------------------------------------------------------------------
 Description:
-    Particle resetting on the GPU requires several random numbers.  GLSL doesn't have GPU 
-    clock-reading functions, so the next best thing is a chaotic hash function 
-    (see Random.comp).  Being a hash function though, if the same values are put into it (like 
-    the Particle's default position XY and velocity XY values of 0), then the result won't 
-    change.  
+    All particles start as "inactive", so they'll be reset by an emitter before they are ever 
+    drawn.  Until then, put them just outside the Z buffer (0 (far) to -1 (near)) so that they 
+    won't draw even if something asks.
 
-    This method gives the particle position and velocity initial random values.
-
-    All particles start as "inactive", so they'll be reset immediately.  This method just gives 
-    them a bump toward randomization.
+    Note: This used to also fill every position and velocity with rand() because the old GPU 
+    random hash needed them as seeds.  The emitters now use a counter-based generator keyed by 
+    the particle's index and the frame (see Random.comp), so there is nothing to seed.
 Parameters: 
     initThese   Self-explanatory.
 Returns:    None
 Creator:    John Cox, 4/2017
 ------------------------------------------------------------------------------------------------*/
-static void InitializeWithRandomData(std::vector<Particle> &initThese)
+static void InitializeOutOfView(std::vector<Particle> &initThese)
 {
-    srand(static_cast<unsigned int>(time(0)));
-
-    float inverseRandMax = 1.0f / RAND_MAX;
     for (size_t particleIndex = 0; particleIndex < initThese.size(); particleIndex++)
     {
-        // randomized X and Y values
-        // Note: Once the sim gets running, the particles will be in window space (X and Y along 
-        // the range [-1,+1]), but for initialiation, this 0-1 range will suffice for 
-        // randomizing float values.  The 0-1 range isn't necessary, but the position and 
-        // velocity values are floats, and dividing by RAND_MAX is an easy way to get a float.  
-        // It just so happens to be along the range 0-1.
-        initThese[particleIndex]._currPos.x = static_cast<float>(rand()) * inverseRandMax;
-        initThese[particleIndex]._currPos.y = static_cast<float>(rand()) * inverseRandMax;
-        
-        // just outside the Z buffer (0 (far) to -1 (near)), so it won't draw
         initThese[particleIndex]._currPos.z = +0.1f;
-
-        initThese[particleIndex]._vel.x = static_cast<float>(rand()) * inverseRandMax;
-        initThese[particleIndex]._vel.y = static_cast<float>(rand()) * inverseRandMax;
     }
 }
 
@@ -76,10 +60,10 @@ Description:
 
     Allocates space for 2x the number of particles.  The second half is used during particle 
     sorting so that particles can be copied to the second half, then copied back to their sorted 
-    positions in the first half.
+    positions in the first half.  If the index sort never physically sorts the particles (see 
+    ParticleIndexSort.comp), then there is no second half.
 
-    Also generates random initial particle positions and velocities, but all particles are still 
-    default inactive.  See description in InitializeWithRandomData(...).
+    All particles are default inactive.  See description in InitializeOutOfView(...).
 
     Uploads the initialized particles to the SSBOs newly allocated buffer memory.
 
@@ -89,10 +73,14 @@ Returns:    None
 Creator:    John Cox, 4/2017
 ------------------------------------------------------------------------------------------------*/
 ParticleSsbo::ParticleSsbo(unsigned int numParticles) :
-    SsboBase()  // generate buffers
+    SsboBase(),  // generate buffers
+    _numParticles(0),
+    _prevPosOffsetBytes(0),
+    _velOffsetBytes(0),
+    _flagsOffsetBytes(0)
 {
     std::vector<Particle> v(numParticles);
-    InitializeWithRandomData(v);
+    InitializeOutOfView(v);
     InitializeParticleTypes(v);
 
     // each particle is 1 vertex, so for particles, "num vertices" == "num items"
@@ -102,8 +90,19 @@ ParticleSsbo::ParticleSsbo(unsigned int numParticles) :
     _numParticles = numParticles;
 
     // the second half has no need for initial data
+#if !USE_PARTICLE_INDEX_SORT || PARTICLE_PHYSICAL_SORT_INTERVAL > 0
     v.resize(numParticles * 2);
+#endif
 
+#if PARTICLE_LAYOUT == PARTICLE_LAYOUT_ARRAYS
+    UploadAsStructureOfArrays(v);
+#elif PARTICLE_LAYOUT == PARTICLE_LAYOUT_COMPACT
+    std::vector<CompactParticle> compactParticles(v.begin(), v.end());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_BUFFER_BINDING, _bufferId);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, compactParticles.size() * sizeof(CompactParticle), compactParticles.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+#else
     // now bind this new buffer to the dedicated buffer binding location
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_BUFFER_BINDING, _bufferId);
 
@@ -111,6 +110,7 @@ ParticleSsbo::ParticleSsbo(unsigned int numParticles) :
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
     glBufferData(GL_SHADER_STORAGE_BUFFER, v.size() * sizeof(Particle), v.data(), GL_DYNAMIC_DRAW);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+#endif
 
     // set up the VAO
     ConfigureRender();
@@ -149,6 +149,62 @@ unsigned int ParticleSsbo::NumParticles() const
     return _numParticles;
 }
 
+/*------------------------------------------------------------------------------------------------
+Description:
+    Only for PARTICLE_LAYOUT_ARRAYS (see ParticleLayout.comp).  Splits the particles into their four 
+    arrays, puts them one after the other in the buffer, and binds each one to its own binding 
+    with glBindBufferRange(...).
+
+    Note: The start of each range has to be a multiple of 
+    GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, so there may be a little padding in between.
+Parameters: 
+    particles   All the particles, including the back half (if there is one).
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void ParticleSsbo::UploadAsStructureOfArrays(const std::vector<Particle> &particles)
+{
+    std::vector<glm::vec2> currPositions(particles.size());
+    std::vector<glm::vec2> prevPositions(particles.size());
+    std::vector<glm::vec2> velocities(particles.size());
+    std::vector<unsigned int> flags(particles.size());
+    for (size_t particleIndex = 0; particleIndex < particles.size(); particleIndex++)
+    {
+        const Particle &p = particles[particleIndex];
+        currPositions[particleIndex] = glm::vec2(p._currPos);
+        prevPositions[particleIndex] = glm::vec2(p._prevPos);
+        velocities[particleIndex] = glm::vec2(p._vel);
+        flags[particleIndex] = PackParticleFlags(p);
+    }
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    auto alignUp = [alignment](unsigned int offsetBytes) -> unsigned int
+    {
+        return ((offsetBytes + alignment - 1) / alignment) * alignment;
+    };
+
+    unsigned int vec2ArraySizeBytes = particles.size() * sizeof(glm::vec2);
+    unsigned int flagsArraySizeBytes = particles.size() * sizeof(unsigned int);
+    _prevPosOffsetBytes = alignUp(vec2ArraySizeBytes);
+    _velOffsetBytes = alignUp(_prevPosOffsetBytes + vec2ArraySizeBytes);
+    _flagsOffsetBytes = alignUp(_velOffsetBytes + vec2ArraySizeBytes);
+    unsigned int totalSizeBytes = _flagsOffsetBytes + flagsArraySizeBytes;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferId);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, totalSizeBytes, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, vec2ArraySizeBytes, currPositions.data());
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, _prevPosOffsetBytes, vec2ArraySizeBytes, prevPositions.data());
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, _velOffsetBytes, vec2ArraySizeBytes, velocities.data());
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, _flagsOffsetBytes, flagsArraySizeBytes, flags.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLE_BUFFER_BINDING, _bufferId, 0, vec2ArraySizeBytes);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLE_PREV_POS_BUFFER_BINDING, _bufferId, _prevPosOffsetBytes, vec2ArraySizeBytes);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLE_VELOCITY_BUFFER_BINDING, _bufferId, _velOffsetBytes, vec2ArraySizeBytes);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLE_FLAGS_BUFFER_BINDING, _bufferId, _flagsOffsetBytes, flagsArraySizeBytes);
+}
+
 /*------------------------------------------------------------------------------------------------
 Description:
     Sets up the vertex attribute pointers for this SSBO's VAO.
@@ -166,6 +222,46 @@ void ParticleSsbo::ConfigureRender()
     glBindVertexArray(_vaoId);
     glBindBuffer(GL_ARRAY_BUFFER, _bufferId);
 
+#if PARTICLE_LAYOUT == PARTICLE_LAYOUT_ARRAYS
+    // same attribute locations as the array of structures, but each one comes from its own 
+    // array
+    // Note: The positions and velocity are only 2 floats.  The vertex shader takes them as 
+    // vec4s, and OpenGL fills in Z = 0 and W = 1.
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)_prevPosOffsetBytes);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)_velOffsetBytes);
+
+    // particle type index, number of nearby particles, and "is active" flag
+    // Note: Packed one byte apiece, like the compact layout, so they are taken as GL_BYTEs.
+    unsigned int flagsStride = sizeof(unsigned int);
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, 1, GL_BYTE, flagsStride, (void *)(_flagsOffsetBytes + (PACKED_PARTICLE_TYPE_INDEX_SHIFT / 8)));
+    glEnableVertexAttribArray(4);
+    glVertexAttribIPointer(4, 1, GL_BYTE, flagsStride, (void *)(_flagsOffsetBytes + (PACKED_PARTICLE_NUM_NEARBY_PARTICLES_SHIFT / 8)));
+    glEnableVertexAttribArray(5);
+    glVertexAttribIPointer(5, 1, GL_BYTE, flagsStride, (void *)(_flagsOffsetBytes + (PACKED_PARTICLE_IS_ACTIVE_SHIFT / 8)));
+#elif PARTICLE_LAYOUT == PARTICLE_LAYOUT_COMPACT
+    // same attribute locations as the array of structures
+    // Note: OpenGL unpacks the half float velocity by itself, and the flags are taken one byte 
+    // apiece (GL_BYTE, so they come out as ints), so ParticleRender.vert doesn't have to know.
+    unsigned int bytesPerStep = sizeof(CompactParticle);
+    unsigned int flagsOffset = offsetof(CompactParticle, _packedFlags);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, bytesPerStep, (void *)offsetof(CompactParticle, _currPos));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, bytesPerStep, (void *)offsetof(CompactParticle, _prevPos));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, bytesPerStep, (void *)offsetof(CompactParticle, _packedVel));
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, 1, GL_BYTE, bytesPerStep, (void *)(flagsOffset + (PACKED_PARTICLE_TYPE_INDEX_SHIFT / 8)));
+    glEnableVertexAttribArray(4);
+    glVertexAttribIPointer(4, 1, GL_BYTE, bytesPerStep, (void *)(flagsOffset + (PACKED_PARTICLE_NUM_NEARBY_PARTICLES_SHIFT / 8)));
+    glEnableVertexAttribArray(5);
+    glVertexAttribIPointer(5, 1, GL_BYTE, bytesPerStep, (void *)(flagsOffset + (PACKED_PARTICLE_IS_ACTIVE_SHIFT / 8)));
+#else
     // vertex attribute order is same as the structure members
 
     GLenum itemType = 0;
@@ -229,6 +325,7 @@ void ParticleSsbo::ConfigureRender()
     glEnableVertexAttribArray(vertexArrayIndex);
     glVertexAttribIPointer(vertexArrayIndex, numItems, itemType, bytesPerStep, (void *)bufferStartOffset);
     bufferStartOffset += sizeOfItem;
+#endif
 
     // cleanup
     glBindVertexArray(0);   // unbind this BEFORE the array or else the VAO will bind to buffer 0
@@ -0,0 +1,58 @@
+#include "Include/Buffers/UboBase.h"
+
+#include "ThirdParty/glload/include/glload/gl_4_4.h"
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Generates the buffer.  Like SsboBase, this means that the OpenGL context MUST be started up 
+    prior to initialization.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+UboBase::UboBase() :
+    _bufferId(0)
+{
+    glGenBuffers(1, &_bufferId);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Cleans up the buffer.  If it is 0, then glDeleteBuffers(...) silently does nothing.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+UboBase::~UboBase()
+{
+    glDeleteBuffers(1, &_bufferId);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Sets any uniforms that go with the uniform block, like how many entries are in use, in the 
+    specified shader.  Same idea as SsboBase::ConfigureConstantUniforms(...).
+
+    The method does nothing though.  Override as needed.
+Parameters: 
+    Ignored
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void UboBase::ConfigureConstantUniforms(unsigned int) const
+{
+    // nothing
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    A simple getter for the buffer's ID.
+Parameters: None
+Returns:
+    A copy of the buffer's ID.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int UboBase::BufferId() const
+{
+    return _bufferId;
+}
@@ -11,13 +11,17 @@ Parameters:
     emitDir     Particles will be launched in this direction evenly along the bar.
     minVel      The minimum velocity for particles being emitted.
     maxVel      The maximum emission velocity.
+    particleTypeIndex   One of ParticleProperties::ParticleType.  Every particle from this 
+                        emitter is this type.
 Returns:    None
 Creator:    John Cox (7-2-2016)
 ------------------------------------------------------------------------------------------------*/
 ParticleEmitterBar::ParticleEmitterBar(const glm::vec2 &p1, const glm::vec2 &p2, 
-    const glm::vec2 &emitDir, const float minVel, const float maxVel) :
+    const glm::vec2 &emitDir, const float minVel, const float maxVel, 
+    const int particleTypeIndex) :
     _minVel(0.0f),
-    _maxVel(0.0f)
+    _maxVel(0.0f),
+    _particleTypeIndex(particleTypeIndex)
 {
     // the start and end points should be translatable
     _start = glm::vec4(p1, 0.0f, 1.0f);
@@ -118,3 +122,16 @@ float ParticleEmitterBar::GetMaxVelocity() const
     return _maxVel;
 }
 
+/*------------------------------------------------------------------------------------------------
+Description:
+    A simple getter for the type of particle that this emitter emits.
+Parameters: None
+Returns:
+    One of ParticleProperties::ParticleType.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+int ParticleEmitterBar::GetParticleTypeIndex() const
+{
+    return _particleTypeIndex;
+}
+
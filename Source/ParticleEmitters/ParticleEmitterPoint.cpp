@@ -7,13 +7,16 @@ Parameters:
     emitterPos  A 2D vector in window space (XY on range [-1,+1]).
     minVel      The minimum velocity for particles being emitted.
     maxVel      The maximum emission velocity.
+    particleTypeIndex   One of ParticleProperties::ParticleType.  Every particle from this 
+                        emitter is this type.
 Returns:    None
 Creator:    John Cox (7-2-2016)
 ------------------------------------------------------------------------------------------------*/
 ParticleEmitterPoint::ParticleEmitterPoint(const glm::vec2 &emitterPos, const float minVel, 
-    const float maxVel) :
+    const float maxVel, const int particleTypeIndex) :
     _minVel(0.0f),
-    _maxVel(0.0f)
+    _maxVel(0.0f),
+    _particleTypeIndex(particleTypeIndex)
 {
     // this demo is in window space, so Z pos is 0, but let it be translatable (4th value is 1)
     _pos = glm::vec4(emitterPos, 0.0f, 1.0f);
@@ -80,4 +83,17 @@ float ParticleEmitterPoint::GetMaxVelocity() const
     return _maxVel;
 }
 
+/*------------------------------------------------------------------------------------------------
+Description:
+    A simple getter for the type of particle that this emitter emits.
+Parameters: None
+Returns:
+    One of ParticleProperties::ParticleType.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+int ParticleEmitterPoint::GetParticleTypeIndex() const
+{
+    return _particleTypeIndex;
+}
+
 
@@ -0,0 +1,69 @@
+#include "Include/ParticleEmitters/ParticleRandom.h"
+
+#include "Shaders/Compute/ParticleReset/RandomSeed.comp"
+
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Makes the starting state the same way as RandomSeedEmission(...) in Random.comp.
+Parameters:
+    emitterIndex    Index of the emitter in the order that ParticleReset uploads them.
+    emitOrdinal     Which of the emitter's particles this is on that frame, starting at 0.
+    frame           The frame number that ParticleReset gave the emission shader.
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+ParticleRandom::ParticleRandom(unsigned int emitterIndex, unsigned int emitOrdinal, unsigned int frame) :
+    _state(0)
+{
+    unsigned int key = PcgHash(emitterIndex ^ PcgHash(frame));
+    _state = PcgHash(PARTICLE_RANDOM_SEED ^ PcgHash(emitOrdinal ^ key));
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Same as RandomPcgHash(...) in Random.comp.
+
+    Note: Unsigned integer overflow wraps around in both C++ and GLSL, so the results match bit 
+    for bit.
+Parameters:
+    value   Self-explanatory
+Returns:
+    A random 32bit unsigned integer.
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+unsigned int ParticleRandom::PcgHash(unsigned int value)
+{
+    unsigned int state = (value * PCG_STATE_MULTIPLIER) + PCG_STATE_INCREMENT;
+    unsigned int word = ((state >> ((state >> 28u) + 4u)) ^ state) * PCG_OUTPUT_MULTIPLIER;
+    return (word >> 22u) ^ word;
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Same as RandomOnRange0To1(...) in Random.comp.
+Parameters: None
+Returns:
+    A random float on the range [0,1).
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+float ParticleRandom::OnRange0To1()
+{
+    _state = (_state * PCG_STATE_MULTIPLIER) + PCG_STATE_INCREMENT;
+    unsigned int word = ((_state >> ((_state >> 28u) + 4u)) ^ _state) * PCG_OUTPUT_MULTIPLIER;
+    word = (word >> 22u) ^ word;
+    return static_cast<float>(word >> 8u) * PCG_INVERSE_FLOAT_RANGE;
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Same as RandomOnRangeNeg1ToPos1(...) in Random.comp.
+Parameters: None
+Returns:
+    A random float on the range [-1,+1).
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+float ParticleRandom::OnRangeNeg1ToPos1()
+{
+    return (2.0f * OnRange0To1()) - 1.0f;
+}
@@ -5,12 +5,15 @@
 
 #include "Shaders/ShaderHeaders/ComputeShaderWorkGroupSizes.comp"
 #include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/Compute/Collisions/ParticleParticle/ContactSolver/ParticleContactSolver.comp"
+#include "Shaders/Compute/DemoScene.comp"
+#include "Shaders/Compute/ParticleSolver.comp"
+#include "Shaders/Compute/FusedParticleUpdate.comp"
 
 // for profiling and checking results
 #include "Include/ShaderControllers/ProfilingWaitToFinish.h"
 #include "Include/Buffers/SortingData.h"
 #include "Include/Buffers/BvhNode.h"
-#include "Include/Buffers/PotentialParticleCollisions.h"
 #include "Include/Buffers/Particle.h"
 #include "Include/Geometry/MyVertex.h"
 #include "Include/Buffers/ParticleProperties.h"
@@ -40,7 +43,7 @@ namespace ShaderControllers
     Creator:    John Cox, 3/2017
     --------------------------------------------------------------------------------------------*/
     ParticleParticleCollisions::ParticleParticleCollisions(const ParticleSsbo::SharedConstPtr particleSsbo,
-        const ParticlePropertiesSsbo::SharedConstPtr particlePropertiesSsbo) :
+        const ParticlePropertiesUbo::SharedConstPtr particlePropertiesUbo) :
         _numParticles(particleSsbo->NumParticles()),
 
         _programIdCopyParticlesToCopyBuffer(0),
@@ -50,25 +53,40 @@ namespace ShaderControllers
         _programIdPrefixScanStage3(0),
         _programIdSortSortingDataWithPrefixSums(0),
         _programIdSortParticles(0),
+        _programIdSortParticleIndexes(0),
+        _programIdRebuildParticleFreeList(0),
         _programIdGuaranteeSortingDataUniqueness(0),
         _programIdGenerateLeafNodeBoundingBoxes(0),
         _programIdGenerateBinaryRadixTree(0),
         _programIdMergeBoundingVolumes(0),
-        _programIdDetectCollisions(0),
-        _programIdResolveCollisions(0),
+        _programIdDetectAndResolveCollisions(0),
+        _unifLocDetectAndResolveDeltaTimeSec(-1),
+        _programIdMeasureParticleDisplacement(0),
+        _programIdDecideNeighbourListRebuild(0),
+        _unifLocDecideRebuildNumWorkGroupsX(-1),
+        _unifLocDecideRebuildPrefixScanNumWorkGroupsX(-1),
+        _programIdDetectContacts(0),
+        _programIdColourContacts(0),
+        _programIdSolveContacts(0),
+        _programIdProjectContactConstraints(0),
+        _unifLocProjectContactConstraintsDeltaTimeSec(-1),
         _programIdGenerateParticleVelocityVectorGeometry(0),
         _programIdGenerateParticleBoundingBoxGeometry(0),
 
         // generate buffers
         _sortingDataSsbo(particleSsbo->NumParticles()),
+        _sortedIndexSsbo(particleSsbo->NumParticles()),
         _prefixSumSsbo(particleSsbo->NumParticles()),
         _bvhNodeSsbo(particleSsbo->NumParticles()),
+        _sweptBoxSsbo(particleSsbo->NumParticles()),
         
         //// Note: For N particles there are N leaves and N-1 internal nodes in the tree, and each 
         //// node's bounding box has 4 faces.  
         //_bvhGeometrySsbo(((particleSsbo->NumParticles() * 2) - 1) * 4),
 
-        _potentialCollisionsSsbo(particleSsbo->NumParticles()),
+        _neighbourListReferenceSsbo(particleSsbo->NumParticles()),
+        _collisionVelocitySsbo(particleSsbo->NumParticles()),
+        _contactSsbo(particleSsbo->NumParticles()),
 
         _velocityVectorGeometrySsbo(particleSsbo->NumParticles()),
         _boundingBoxGeometrySsbo(particleSsbo->NumParticles()),
@@ -79,26 +97,36 @@ namespace ShaderControllers
         AssembleSortingShaders();
         AssembleBvhShaders();
         AssembleCollisionShaders();
+        AssembleContactSolverShaders();
         AssembleGeometryCreationShaders();
 
         // load the buffer size uniforms where the SSBOs will be used
         particleSsbo->ConfigureConstantUniforms(_programIdCopyParticlesToCopyBuffer);
         particleSsbo->ConfigureConstantUniforms(_programIdGenerateSortingData);
         particleSsbo->ConfigureConstantUniforms(_programIdSortParticles);
+        particleSsbo->ConfigureConstantUniforms(_programIdRebuildParticleFreeList);
         particleSsbo->ConfigureConstantUniforms(_programIdGenerateLeafNodeBoundingBoxes);
-        particleSsbo->ConfigureConstantUniforms(_programIdDetectCollisions);
-        particleSsbo->ConfigureConstantUniforms(_programIdResolveCollisions);
+        particleSsbo->ConfigureConstantUniforms(_programIdDetectAndResolveCollisions);
+        particleSsbo->ConfigureConstantUniforms(_programIdMeasureParticleDisplacement);
+        particleSsbo->ConfigureConstantUniforms(_programIdDetectContacts);
+        particleSsbo->ConfigureConstantUniforms(_programIdColourContacts);
+        particleSsbo->ConfigureConstantUniforms(_programIdSolveContacts);
+        particleSsbo->ConfigureConstantUniforms(_programIdProjectContactConstraints);
         particleSsbo->ConfigureConstantUniforms(_programIdGenerateParticleBoundingBoxGeometry);
         particleSsbo->ConfigureConstantUniforms(_programIdGenerateParticleVelocityVectorGeometry);
 
-        particlePropertiesSsbo->ConfigureConstantUniforms(_programIdGenerateLeafNodeBoundingBoxes);
-        particlePropertiesSsbo->ConfigureConstantUniforms(_programIdResolveCollisions);
-        particlePropertiesSsbo->ConfigureConstantUniforms(_programIdGenerateParticleBoundingBoxGeometry);
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdGenerateLeafNodeBoundingBoxes);
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdDetectAndResolveCollisions);
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdDetectContacts);
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdSolveContacts);
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdProjectContactConstraints);
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdGenerateParticleBoundingBoxGeometry);
 
         _sortingDataSsbo.ConfigureConstantUniforms(_programIdGenerateSortingData);
         _sortingDataSsbo.ConfigureConstantUniforms(_programIdPrefixScanStage1);
         _sortingDataSsbo.ConfigureConstantUniforms(_programIdSortSortingDataWithPrefixSums);
         _sortingDataSsbo.ConfigureConstantUniforms(_programIdSortParticles);
+        _sortingDataSsbo.ConfigureConstantUniforms(_programIdSortParticleIndexes);
         _sortingDataSsbo.ConfigureConstantUniforms(_programIdGuaranteeSortingDataUniqueness);
         _sortingDataSsbo.ConfigureConstantUniforms(_programIdGenerateBinaryRadixTree);
 
@@ -110,10 +138,20 @@ namespace ShaderControllers
         _bvhNodeSsbo.ConfigureConstantUniforms(_programIdGenerateLeafNodeBoundingBoxes);
         _bvhNodeSsbo.ConfigureConstantUniforms(_programIdGenerateBinaryRadixTree);
         _bvhNodeSsbo.ConfigureConstantUniforms(_programIdMergeBoundingVolumes);
-        _bvhNodeSsbo.ConfigureConstantUniforms(_programIdDetectCollisions);
+        _bvhNodeSsbo.ConfigureConstantUniforms(_programIdDetectAndResolveCollisions);
+        _bvhNodeSsbo.ConfigureConstantUniforms(_programIdDetectContacts);
 
-        _potentialCollisionsSsbo.ConfigureConstantUniforms(_programIdDetectCollisions);
-        _potentialCollisionsSsbo.ConfigureConstantUniforms(_programIdResolveCollisions);
+        _neighbourListReferenceSsbo.ConfigureConstantUniforms(_programIdGenerateLeafNodeBoundingBoxes);
+        _neighbourListReferenceSsbo.ConfigureConstantUniforms(_programIdMeasureParticleDisplacement);
+        _neighbourListReferenceSsbo.ConfigureConstantUniforms(_programIdDecideNeighbourListRebuild);
+
+        _collisionVelocitySsbo.ConfigureConstantUniforms(_programIdSortParticles);
+        _collisionVelocitySsbo.ConfigureConstantUniforms(_programIdDetectAndResolveCollisions);
+
+        _contactSsbo.ConfigureConstantUniforms(_programIdDetectContacts);
+        _contactSsbo.ConfigureConstantUniforms(_programIdColourContacts);
+        _contactSsbo.ConfigureConstantUniforms(_programIdSolveContacts);
+        _contactSsbo.ConfigureConstantUniforms(_programIdProjectContactConstraints);
 
         _velocityVectorGeometrySsbo.ConfigureConstantUniforms(_programIdGenerateParticleVelocityVectorGeometry);
 
@@ -121,13 +159,13 @@ namespace ShaderControllers
 
 
         //unsigned int startingIndexBytes = 0;
-        //std::vector<ParticleProperties> checkParticlePropertiesBuffer(particlePropertiesSsbo->NumProperties());
+        //std::vector<ParticleProperties> checkParticlePropertiesBuffer(particlePropertiesUbo->NumProperties());
         //unsigned int bufferSizeBytes = checkParticlePropertiesBuffer.size() * sizeof(ParticleProperties);
-        //glBindBuffer(GL_SHADER_STORAGE_BUFFER, particlePropertiesSsbo->BufferId());
-        //void *bufferPtr = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, startingIndexBytes, bufferSizeBytes, GL_MAP_READ_BIT);
+        //glBindBuffer(GL_UNIFORM_BUFFER, particlePropertiesUbo->BufferId());
+        //void *bufferPtr = glMapBufferRange(GL_UNIFORM_BUFFER, startingIndexBytes, bufferSizeBytes, GL_MAP_READ_BIT);
         //memcpy(checkParticlePropertiesBuffer.data(), bufferPtr, bufferSizeBytes);
-        //glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-        //glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        //glUnmapBuffer(GL_UNIFORM_BUFFER);
+        //glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
 
         //unsigned int startingIndexBytes = 0;
@@ -159,12 +197,19 @@ namespace ShaderControllers
         glDeleteProgram(_programIdPrefixScanStage3);
         glDeleteProgram(_programIdSortSortingDataWithPrefixSums);
         glDeleteProgram(_programIdSortParticles);
+        glDeleteProgram(_programIdSortParticleIndexes);
+        glDeleteProgram(_programIdRebuildParticleFreeList);
         glDeleteProgram(_programIdGuaranteeSortingDataUniqueness);
         glDeleteProgram(_programIdGenerateLeafNodeBoundingBoxes);
         glDeleteProgram(_programIdGenerateBinaryRadixTree);
         glDeleteProgram(_programIdMergeBoundingVolumes);
-        glDeleteProgram(_programIdDetectCollisions);
-        glDeleteProgram(_programIdResolveCollisions);
+        glDeleteProgram(_programIdDetectAndResolveCollisions);
+        glDeleteProgram(_programIdMeasureParticleDisplacement);
+        glDeleteProgram(_programIdDecideNeighbourListRebuild);
+        glDeleteProgram(_programIdDetectContacts);
+        glDeleteProgram(_programIdColourContacts);
+        glDeleteProgram(_programIdSolveContacts);
+        glDeleteProgram(_programIdProjectContactConstraints);
         glDeleteProgram(_programIdGenerateParticleVelocityVectorGeometry);
         glDeleteProgram(_programIdGenerateParticleBoundingBoxGeometry);
     }
@@ -205,15 +250,34 @@ namespace ShaderControllers
             (b) generate the binary radix tree out of the particle sorting data
             (c) merge bounding boxes from the leaves up to the root of the tree
         (3) detect and resolve collisions
-            (a) traverse the BVH and detect overlaps with leaves (other particles)
-            (b) resolve any overlaps collisions
+            (a) traverse the BVH, and for each overlap with a leaf (another particle), check for 
+                and resolve an actual collision
+            or, if PARTICLE_SOLVER is the contact solver or XPBD (see ParticleSolver.comp)
+            (a) traverse the BVH and record every overlapping particle
+            (b) colour the contact graph
+            (c) make several sweeps over the colours, pushing overlapping particles apart
+
+        Steps (1) and (2) are expensive, so they are skipped if the BVH from a previous frame is 
+        still good.  Each leaf's bounding box is enlarged by a "skin", and as long as no 
+        particle has moved more than half the skin since the BVH was built, then the particles 
+        don't need to be sorted again, the BVH does not need to change, and only (3) needs to 
+        run (see NeighbourListSkin.comp).
+
+        Note: Newly emitted particles are not in the BVH, so they always force a rebuild.  The 
+        skin only pays off on frames when nothing was emitted.
 
         I want to profile each step, so all the most-indented steps are in their own 
         shader-dispatching functions.  The "profiling" version of each stage ((1), (2), and (3)) 
         will surround the calls to these functions with profiling stuff and the resulting times 
         will be tallied and recorded.  The non-profiling versions will simply call each 
         shader-dispatching function.
+        Also Note: ParticleUpdate.comp wrote this frame's velocities into the "write" half of the 
+        ParticleCollisionVelocitySsbo, so that is swapped to the "read" half before anything 
+        reads it (see ParticleCollisionVelocityBuffer.comp).
     Parameters: 
+        deltaTimeSec    Used by the velocity exchange solver to work out where the other 
+                        particle was before it collided, and by the XPBD solver to scale the 
+                        contacts' compliance.
         withProfiling   If true, performs the sorting, BVH generation, and collision detection 
                         and resolution with std::chrono calls, forced waiting for each shader to 
                         finish, and reporting of the durations to stdout and to files.  
@@ -224,8 +288,18 @@ namespace ShaderControllers
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::DetectAndResolve(bool withProfiling, bool generateGeometry) const
+    void ParticleParticleCollisions::DetectAndResolve(float deltaTimeSec, bool withProfiling, bool generateGeometry)
     {
+#if PARTICLE_SOLVER == PARTICLE_SOLVER_VELOCITY_EXCHANGE
+        _collisionVelocitySsbo.Swap();
+#endif
+
+        glUseProgram(_programIdDetectAndResolveCollisions);
+        glUniform1f(_unifLocDetectAndResolveDeltaTimeSec, deltaTimeSec);
+        glUseProgram(_programIdProjectContactConstraints);
+        glUniform1f(_unifLocProjectContactConstraintsDeltaTimeSec, deltaTimeSec);
+        glUseProgram(0);
+
         // most shaders work on 1 item per thread
         int numWorkGroupsX = _numParticles / WORK_GROUP_SIZE_X;
         int remainder = _numParticles % WORK_GROUP_SIZE_X;
@@ -239,16 +313,28 @@ namespace ShaderControllers
         remainder = numItemsInPrefixScanBuffer % (WORK_GROUP_SIZE_X * 2);
         numWorkGroupsXForPrefixSum += (remainder == 0) ? 0 : 1;
 
+        // the sorting and BVH generation are always dispatched, but if the BVH is still good, 
+        // then the GPU gives them 0 work groups
+        DecideIfNeighbourListsNeedRebuilding(numWorkGroupsX, numWorkGroupsXForPrefixSum);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, _neighbourListReferenceSsbo.BufferId());
+        if (withProfiling)
+        {
+            SortParticlesWithProfiling();
+            GenerateBvhWithProfiling();
+        }
+        else
+        {
+            SortParticlesWithoutProfiling();
+            GenerateBvhWithoutProfiling();
+        }
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+
         if (withProfiling)
         {
-            SortParticlesWithProfiling(numWorkGroupsX, numWorkGroupsXForPrefixSum);
-            GenerateBvhWithProfiling(numWorkGroupsX);
             DetectAndResolveCollisionsWithProfiling(numWorkGroupsX);
         }
         else
         {
-            SortParticlesWithoutProfiling(numWorkGroupsX, numWorkGroupsXForPrefixSum);
-            GenerateBvhWithoutProfiling(numWorkGroupsX);
             DetectAndResolveCollisionsWithoutProfiling(numWorkGroupsX);
         }
 
@@ -288,6 +374,23 @@ namespace ShaderControllers
         return _boundingBoxGeometrySsbo;
     }
 
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        Used to show how often the BVH is rebuilt and how often the neighbour list skin lets it 
+        be skipped (see NeighbourListSkin.comp).
+
+        Note: This waits for the GPU to catch up, so don't call it every frame.
+    Parameters: 
+        numDecisions    Out.  How many times DetectAndResolve(...) has decided.
+        numRebuilds     Out.  How many of those decided to rebuild.
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    void ParticleParticleCollisions::ReadNeighbourListRebuildCounts(unsigned int &numDecisions, unsigned int &numRebuilds) const
+    {
+        _neighbourListReferenceSsbo.ReadRebuildCounts(numDecisions, numRebuilds);
+    }
+
     /*--------------------------------------------------------------------------------------------
     Description:
         Primarily serves to clean up the constructor.
@@ -352,6 +455,20 @@ namespace ShaderControllers
         shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
         shaderStorageRef.LinkShader(shaderKey);
         _programIdSortParticles = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        shaderKey = "sort particle indexes";
+        filePath = "Shaders/Compute/Collisions/ParticleParticle/Sorting/SortParticleIndexes.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdSortParticleIndexes = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        shaderKey = "rebuild particle free list";
+        filePath = "Shaders/Compute/Collisions/ParticleParticle/Sorting/RebuildParticleFreeList.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdRebuildParticleFreeList = shaderStorageRef.GetShaderProgram(shaderKey);
     }
 
     /*--------------------------------------------------------------------------------------------
@@ -415,19 +532,78 @@ namespace ShaderControllers
         std::string shaderKey;
         std::string filePath;
 
-        shaderKey = "detect particle-particle collisions";
-        filePath = "Shaders/Compute/Collisions/ParticleParticle/DetectParticleParticleCollisions.comp";
+        shaderKey = "detect and resolve particle-particle collisions";
+        filePath = "Shaders/Compute/Collisions/ParticleParticle/DetectAndResolveParticleParticleCollisions.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdDetectAndResolveCollisions = shaderStorageRef.GetShaderProgram(shaderKey);
+        _unifLocDetectAndResolveDeltaTimeSec = shaderStorageRef.GetUniformLocation(shaderKey, "uDeltaTimeSec");
+
+        shaderKey = "measure particle displacement";
+        filePath = "Shaders/Compute/Collisions/ParticleParticle/MeasureParticleDisplacement.comp";
         shaderStorageRef.NewShader(shaderKey);
         shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
         shaderStorageRef.LinkShader(shaderKey);
-        _programIdDetectCollisions = shaderStorageRef.GetShaderProgram(shaderKey);
+        _programIdMeasureParticleDisplacement = shaderStorageRef.GetShaderProgram(shaderKey);
 
-        shaderKey = "resolve particle-particle collisions";
-        filePath = "Shaders/Compute/Collisions/ParticleParticle/ResolveParticleParticleCollisions.comp";
+        shaderKey = "decide neighbour list rebuild";
+        filePath = "Shaders/Compute/Collisions/ParticleParticle/DecideNeighbourListRebuild.comp";
         shaderStorageRef.NewShader(shaderKey);
         shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
         shaderStorageRef.LinkShader(shaderKey);
-        _programIdResolveCollisions = shaderStorageRef.GetShaderProgram(shaderKey);
+        _programIdDecideNeighbourListRebuild = shaderStorageRef.GetShaderProgram(shaderKey);
+        _unifLocDecideRebuildNumWorkGroupsX = shaderStorageRef.GetUniformLocation(shaderKey, "uRebuildNumWorkGroupsX");
+        _unifLocDecideRebuildPrefixScanNumWorkGroupsX = shaderStorageRef.GetUniformLocation(shaderKey, "uRebuildPrefixScanNumWorkGroupsX");
+    }
+
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        Primarily serves to clean up the constructor.
+
+        Assembles headers, buffers, and functional .comp files for the shaders that make up the 
+        particle-particle contact solver.
+
+        Note: These are compiled no matter which PARTICLE_SOLVER is selected.  They are small 
+        shaders, and this way they can't quietly stop compiling while nobody is using them.
+    Parameters: None
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    void ParticleParticleCollisions::AssembleContactSolverShaders()
+    {
+        ShaderStorage &shaderStorageRef = ShaderStorage::GetInstance();
+        std::string shaderKey;
+        std::string filePath;
+
+        shaderKey = "detect particle contacts";
+        filePath = "Shaders/Compute/Collisions/ParticleParticle/ContactSolver/DetectParticleContacts.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdDetectContacts = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        shaderKey = "colour particle contacts";
+        filePath = "Shaders/Compute/Collisions/ParticleParticle/ContactSolver/ColourParticleContacts.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdColourContacts = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        shaderKey = "solve particle contacts";
+        filePath = "Shaders/Compute/Collisions/ParticleParticle/ContactSolver/SolveParticleContacts.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdSolveContacts = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        shaderKey = "project particle contact constraints";
+        filePath = "Shaders/Compute/Collisions/ParticleParticle/ContactSolver/ProjectParticleContactConstraints.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdProjectContactConstraints = shaderStorageRef.GetShaderProgram(shaderKey);
+        _unifLocProjectContactConstraintsDeltaTimeSec = shaderStorageRef.GetUniformLocation(shaderKey, "uDeltaTimeSec");
     }
 
     /*--------------------------------------------------------------------------------------------
@@ -465,15 +641,16 @@ namespace ShaderControllers
     Description:
         This method governs the shader dispatches that will result in sorting the ParticleBuffer 
         and ParticleSortingDataBuffer.
-    Parameters: 
-        numWorkGroupsX  Expected to be the total particle count divided by work group size.
-        numWorkGroupsXPrefixScan    See comment where this value was calculated.
+
+        Note: Every dispatch is indirect (see DecideNeighbourListRebuild.comp), so the 
+        ParticleNeighbourListReferenceSsbo must be bound to GL_DISPATCH_INDIRECT_BUFFER.
+    Parameters: None
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::SortParticlesWithoutProfiling(unsigned int numWorkGroupsX, unsigned int numWorkGroupsXPrefixScan) const
+    void ParticleParticleCollisions::SortParticlesWithoutProfiling() const
     {
-        PrepareToSortParticles(numWorkGroupsX);
+        PrepareToSortParticles();
 
         // parallel radix sorting algorithm over each bit of the Morton Codes 
         // Note: MUST sort over all 32 bits in GLSL's uint.  See GenerateSortingData.comp for 
@@ -492,15 +669,15 @@ namespace ShaderControllers
             sortingDataReadBufferOffset = static_cast<unsigned int>(!writeToSecondBuffer) * _numParticles;
             sortingDataWriteBufferOffset = static_cast<unsigned int>(writeToSecondBuffer) * _numParticles;
 
-            PrefixScan(numWorkGroupsXPrefixScan, bitNumber, sortingDataReadBufferOffset);
-            SortSortingDataWithPrefixScan(numWorkGroupsX, bitNumber, sortingDataReadBufferOffset, sortingDataWriteBufferOffset);
+            PrefixScan(bitNumber, sortingDataReadBufferOffset);
+            SortSortingDataWithPrefixScan(bitNumber, sortingDataReadBufferOffset, sortingDataWriteBufferOffset);
 
             // swap read/write buffers and do it again
             writeToSecondBuffer = !writeToSecondBuffer;
         }
 
         // the sorting data's final location is in the "write" half of the sorting data buffer
-        SortParticlesUsingSortingData(numWorkGroupsX, sortingDataWriteBufferOffset);
+        SortParticlesUsingSortingData(sortingDataWriteBufferOffset);
 
         // all done
         glUseProgram(0);
@@ -513,15 +690,16 @@ namespace ShaderControllers
         (2) forced wait for shader to finish so that the std::chrono calls get an accurate 
             reading for how long the shader takes 
         (3) writing the output to a file (if desired)
-    Parameters: 
-        numWorkGroupsX  Expected to be the total particle count divided by work group size.
-        numWorkGroupsXPrefixScan    See comment where this value was calculated.
+
+        Note: If the GPU decided that the BVH is still good, then this times the empty 
+        dispatches.
+    Parameters: None
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::SortParticlesWithProfiling(unsigned int numWorkGroupsX, unsigned int numWorkGroupsXPrefixScan) const
+    void ParticleParticleCollisions::SortParticlesWithProfiling() const
     {
-        cout << "sorting " << _numParticles << " particles" << endl;
+        cout << "sorting up to " << _numParticles << " particles" << endl;
         unsigned int totalBitCount = 32;
 
         // for profiling
@@ -531,7 +709,7 @@ namespace ShaderControllers
         long long totalSortingTime = 0;
 
         start = high_resolution_clock::now();
-        PrepareToSortParticles(numWorkGroupsX);
+        PrepareToSortParticles();
 
         bool writeToSecondBuffer = true;
         unsigned int sortingDataReadBufferOffset = 0;
@@ -541,15 +719,15 @@ namespace ShaderControllers
             sortingDataReadBufferOffset = static_cast<unsigned int>(!writeToSecondBuffer) * _numParticles;
             sortingDataWriteBufferOffset = static_cast<unsigned int>(writeToSecondBuffer) * _numParticles;
 
-            PrefixScan(numWorkGroupsXPrefixScan, bitNumber, sortingDataReadBufferOffset);
-            SortSortingDataWithPrefixScan(numWorkGroupsX, bitNumber, sortingDataReadBufferOffset, sortingDataWriteBufferOffset);
+            PrefixScan(bitNumber, sortingDataReadBufferOffset);
+            SortSortingDataWithPrefixScan(bitNumber, sortingDataReadBufferOffset, sortingDataWriteBufferOffset);
 
             // swap read/write buffers and do it again
             writeToSecondBuffer = !writeToSecondBuffer;
         }
 
         // wherever the sorting data ended up, that is where the shader should read from
-        SortParticlesUsingSortingData(numWorkGroupsX, sortingDataWriteBufferOffset);
+        SortParticlesUsingSortingData(sortingDataWriteBufferOffset);
 
         end = high_resolution_clock::now();
         totalSortingTime = duration_cast<microseconds>(end - start).count();
@@ -573,16 +751,17 @@ namespace ShaderControllers
     Description:
         This method governs the shader dispatches that will result in a balanced binary tree of 
         bounding boxes from the leaves (particles) up to the root of the tree.
-    Parameters: 
-        numWorkGroupsX  Expected to be the total particle count divided by work group size.
+
+        Note: Every dispatch is indirect, like in SortParticlesWithoutProfiling().
+    Parameters: None
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::GenerateBvhWithoutProfiling(unsigned int numWorkGroupsX) const
+    void ParticleParticleCollisions::GenerateBvhWithoutProfiling() const
     {
-        PrepareForBinaryTree(numWorkGroupsX);
-        GenerateBinaryRadixTree(numWorkGroupsX);
-        MergeNodesIntoBvh(numWorkGroupsX);
+        PrepareForBinaryTree();
+        GenerateBinaryRadixTree();
+        MergeNodesIntoBvh();
     }
 
     /*--------------------------------------------------------------------------------------------
@@ -593,14 +772,13 @@ namespace ShaderControllers
             reading for how long the shader takes 
         (3) verification of a valid tree (all nodes' parent-child relationships are reciprocated)
         (4) writing the output to a file (if desired)
-    Parameters: 
-        numWorkGroupsX  Expected to be the total particle count divided by work group size.
+    Parameters: None
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::GenerateBvhWithProfiling(unsigned int numWorkGroupsX) const
+    void ParticleParticleCollisions::GenerateBvhWithProfiling() const
     {
-        cout << "generating BVH for " << _numParticles << " particles" << endl;
+        cout << "generating BVH for up to " << _numParticles << " particles" << endl;
 
         // for profiling
         using namespace std::chrono;
@@ -612,21 +790,21 @@ namespace ShaderControllers
 
         // prep data
         start = high_resolution_clock::now();
-        PrepareForBinaryTree(numWorkGroupsX);
+        PrepareForBinaryTree();
         WaitForComputeToFinish();
         end = high_resolution_clock::now();
         durationPrepData = duration_cast<microseconds>(end - start).count();
 
         // generate the tree
         start = high_resolution_clock::now();
-        GenerateBinaryRadixTree(numWorkGroupsX);
+        GenerateBinaryRadixTree();
         WaitForComputeToFinish();
         end = high_resolution_clock::now();
         durationGenerateTree = duration_cast<microseconds>(end - start).count();
 
         // populate the tree with bounding volumes to finish the BVH
         start = high_resolution_clock::now();
-        MergeNodesIntoBvh(numWorkGroupsX);
+        MergeNodesIntoBvh();
         WaitForComputeToFinish();
         end = high_resolution_clock::now();
         durationMergeBoundingBoxes = duration_cast<microseconds>(end - start).count();
@@ -665,8 +843,7 @@ namespace ShaderControllers
     void ParticleParticleCollisions::DetectAndResolveCollisionsWithoutProfiling(
         unsigned int numWorkGroupsX) const
     {
-        DetectCollisions(numWorkGroupsX);
-        ResolveCollisions(numWorkGroupsX);
+        DetectAndResolveCollisions(numWorkGroupsX);
     }
 
     /*--------------------------------------------------------------------------------------------
@@ -693,29 +870,13 @@ namespace ShaderControllers
         using namespace std::chrono;
         steady_clock::time_point start;
         steady_clock::time_point end;
-        long long durationDetectCollisions = 0;
-        long long durationResolveCollisions = 0;
+        long long durationDetectAndResolveCollisions = 0;
 
         start = high_resolution_clock::now();
-        DetectCollisions(numWorkGroupsX);
+        DetectAndResolveCollisions(numWorkGroupsX);
         WaitForComputeToFinish();
         end = high_resolution_clock::now();
-        durationDetectCollisions = duration_cast<microseconds>(end - start).count();
-
-        start = high_resolution_clock::now();
-        ResolveCollisions(numWorkGroupsX);
-        WaitForComputeToFinish();
-        end = high_resolution_clock::now();
-        durationResolveCollisions = duration_cast<microseconds>(end - start).count();
-
-        //unsigned int startingIndexBytes = 0;
-        //std::vector<PotentialParticleCollisions> checkPotentialCollisions(_particlePotentialCollisionsSsbo.NumItems());
-        //unsigned int bufferSizeBytes = checkPotentialCollisions.size() * sizeof(PotentialParticleCollisions);
-        //glBindBuffer(GL_SHADER_STORAGE_BUFFER, _particlePotentialCollisionsSsbo.BufferId());
-        //void *bufferPtr = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, startingIndexBytes, bufferSizeBytes, GL_MAP_READ_BIT);
-        //memcpy(checkPotentialCollisions.data(), bufferPtr, bufferSizeBytes);
-        //glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-        //glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        durationDetectAndResolveCollisions = duration_cast<microseconds>(end - start).count();
 
         //unsigned int startingIndexBytes = 0;
         //std::vector<Particle> checkPostCollisionParticles(_originalParticleSsbo->NumParticles());
@@ -740,34 +901,69 @@ namespace ShaderControllers
         std::ofstream outFile("ProfilingDurations/DetectAndResolveParticleParticleCollisions.txt");
         if (outFile.is_open())
         {
-            long long totalSortingTime = durationDetectCollisions + durationResolveCollisions;
-
             cout << "particle-particle collision handling time:" << endl <<
-                "\ttotal: " << totalSortingTime << endl <<
-                "\tdetect collisions: " << durationDetectCollisions << endl <<
-                "\tresolve collisions: " << durationResolveCollisions << endl;
+                "\ttotal: " << durationDetectAndResolveCollisions << endl;
             outFile << "particle-particle collision handling time:" << endl <<
-                "\ttotal: " << totalSortingTime << endl <<
-                "\tdetect collisions: " << durationDetectCollisions << endl <<
-                "\tresolve collisions: " << durationResolveCollisions << endl;
+                "\ttotal: " << durationDetectAndResolveCollisions << endl;
         }
         outFile.close();
     }
 
     /*--------------------------------------------------------------------------------------------
     Description:
-        Part of particle sorting.
+        Finds the largest distance that any particle has moved since the BVH was last built, 
+        and then has the GPU compare it against half the neighbour list skin and set up the 
+        sorting and BVH generation's indirect dispatches (see DecideNeighbourListRebuild.comp).  
+
+        Note: Nothing is read back, so this doesn't wait on the GPU.
     Parameters: 
-        numWorkGroupsX      Expected to be number of particles divided by work group size.
+        numWorkGroupsX              Expected to be number of particles divided by work group 
+                                    size.
+        numWorkGroupsXPrefixScan    See comment where this value was calculated.
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    void ParticleParticleCollisions::DecideIfNeighbourListsNeedRebuilding(unsigned int numWorkGroupsX, unsigned int numWorkGroupsXPrefixScan) const
+    {
+        glUseProgram(_programIdMeasureParticleDisplacement);
+        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glUseProgram(_programIdDecideNeighbourListRebuild);
+        glUniform1ui(_unifLocDecideRebuildNumWorkGroupsX, numWorkGroupsX);
+        glUniform1ui(_unifLocDecideRebuildPrefixScanNumWorkGroupsX, numWorkGroupsXPrefixScan);
+        glDispatchCompute(1, 1, 1);
+
+        // the next dispatches read their work group counts from the buffer
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+        glUseProgram(0);
+    }
+
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        Part of particle sorting.
+
+        Note: The particles only need to be copied to the back half of the ParticleBuffer if 
+        they are going to be moved.
+
+        Also Note: If USE_FUSED_PARTICLE_UPDATE is on (see FusedParticleUpdate.comp), then 
+        ParticleUpdate.comp already wrote the sorting data.
+
+        Also Also Note: The GPU decides if the sort is physical (see 
+        DecideNeighbourListRebuild.comp), so the copy always goes through its own indirect 
+        dispatch, which has 0 work groups if not.
+    Parameters: None
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::PrepareToSortParticles(unsigned int numWorkGroupsX) const
+    void ParticleParticleCollisions::PrepareToSortParticles() const
     {
         glUseProgram(_programIdCopyParticlesToCopyBuffer);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::PhysicalSortDispatchOffsetBytes());
+#if !USE_FUSED_PARTICLE_UPDATE
         glUseProgram(_programIdGenerateSortingData);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildDispatchOffsetBytes());
+#endif
 
         // the two shaders worked on different buffers, so only need one memory barrier 
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
@@ -790,20 +986,19 @@ namespace ShaderControllers
         Note: The work group size is special here.  The algorithm calls for each thread to work 
         on two items, so the expected work group count is the number of particles divided by 2x 
         the work group size.  Sufficiant buffer size was allocated for this algorithm in 
-        ParticlePrefixSumSsbo.
+        ParticlePrefixSumSsbo.  The GPU has that count (see DecideNeighbourListRebuild.comp).
     Parameters: 
-        numWorkGroupsX          See Description
         bitNumber               0 - 32
         sortingDataReadOffset   The sorting data is read from this half of the buffer.
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::PrefixScan(unsigned int numWorkGroupsX, unsigned int bitNumber, unsigned int sortingDataReadOffset) const
+    void ParticleParticleCollisions::PrefixScan(unsigned int bitNumber, unsigned int sortingDataReadOffset) const
     {
         glUseProgram(_programIdPrefixScanStage1);
         glUniform1ui(UNIFORM_LOCATION_PARTICLE_SORTING_DATA_BUFFER_READ_OFFSET, sortingDataReadOffset);
         glUniform1ui(UNIFORM_LOCATION_BIT_NUMBER, bitNumber);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildPrefixScanDispatchOffsetBytes());
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
         //unsigned int startingIndexBytes = 0;
@@ -816,7 +1011,7 @@ namespace ShaderControllers
         //glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
         glUseProgram(_programIdPrefixScanStage2);
-        glDispatchCompute(1, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildSingleWorkGroupDispatchOffsetBytes());
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
         //glBindBuffer(GL_SHADER_STORAGE_BUFFER, _prefixSumSsbo.BufferId());
@@ -826,7 +1021,7 @@ namespace ShaderControllers
         //glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
         glUseProgram(_programIdPrefixScanStage3);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildPrefixScanDispatchOffsetBytes());
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
         //glBindBuffer(GL_SHADER_STORAGE_BUFFER, _prefixSumSsbo.BufferId());
@@ -857,22 +1052,20 @@ namespace ShaderControllers
     Description:
         Part of particle sorting.  
     Parameters: 
-        numWorkGroupsX          Expected to be number of particles divided by work group size.
         bitNumber               0 - 32
         sortingDataReadOffset   The sorting data is read from this half of the buffer...
         sortingDataWriteOffset  And sorted according to the prefix sums into this half.
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::SortSortingDataWithPrefixScan(
-        unsigned int numWorkGroupsX, unsigned int bitNumber, 
+    void ParticleParticleCollisions::SortSortingDataWithPrefixScan(unsigned int bitNumber, 
         unsigned int sortingDataReadOffset, unsigned int sortingDataWriteOffset) const
     {
         glUseProgram(_programIdSortSortingDataWithPrefixSums);
         glUniform1ui(UNIFORM_LOCATION_PARTICLE_SORTING_DATA_BUFFER_READ_OFFSET, sortingDataReadOffset);
         glUniform1ui(UNIFORM_LOCATION_PARTICLE_SORTING_DATA_BUFFER_WRITE_OFFSET, sortingDataWriteOffset);
         glUniform1ui(UNIFORM_LOCATION_BIT_NUMBER, bitNumber);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildDispatchOffsetBytes());
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
         //unsigned int startingIndexBytes = sortingDataWriteOffset * sizeof(SortingData);
@@ -899,16 +1092,22 @@ namespace ShaderControllers
 
     /*--------------------------------------------------------------------------------------------
     Description:
-        The end of particle sorting.
+        The end of particle sorting.  Also rebuilds the free list of inactive particles (see 
+        RebuildParticleFreeList.comp), because the sort just moved them all.
+
+        If this isn't a physical sort (see ParticleIndexSort.comp), then the particles stay 
+        where they are and only their sorted order is written.  The free list is still rebuilt 
+        so that emitters fill the particles in sorted order.
+
+        Note: The GPU decides which one it is (see DecideNeighbourListRebuild.comp), so both are 
+        dispatched and one of them gets 0 work groups.
     Parameters: 
-        numWorkGroupsX          Expected to be number of particles divided by work group size.
         sortingDataReadOffset   Tells the shader which half of the ParticleSortingDataBuffer has 
                                 the latest sort values.
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::SortParticlesUsingSortingData(unsigned int numWorkGroupsX,
-        unsigned int sortingDataReadOffset) const
+    void ParticleParticleCollisions::SortParticlesUsingSortingData(unsigned int sortingDataReadOffset) const
     {
         //// verify sorted data
         //// Note: Only need to copy the first half of the buffer.  This is where the last loop of 
@@ -938,7 +1137,15 @@ namespace ShaderControllers
 
         glUseProgram(_programIdSortParticles);
         glUniform1ui(UNIFORM_LOCATION_PARTICLE_SORTING_DATA_BUFFER_READ_OFFSET, sortingDataReadOffset);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::PhysicalSortDispatchOffsetBytes());
+        glUseProgram(_programIdSortParticleIndexes);
+        glUniform1ui(UNIFORM_LOCATION_PARTICLE_SORTING_DATA_BUFFER_READ_OFFSET, sortingDataReadOffset);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::IndexSortDispatchOffsetBytes());
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        // the particles moved (or their order changed), so the free list's indices are stale
+        glUseProgram(_programIdRebuildParticleFreeList);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildDispatchOffsetBytes());
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
     }
 
@@ -947,17 +1154,16 @@ namespace ShaderControllers
         Modifies the ParticleSortingDataBuffer so that the resulting tree won't have depth 
         spikes due to duplicate entries, then gives each leaf node in the ParticleBvhNodeBuffer a 
         bounding box based on the particle that it is associated with.
-    Parameters: 
-        numWorkGroupsX      Expected to be the number of particles divided by work group size.
+    Parameters: None
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::PrepareForBinaryTree(unsigned int numWorkGroupsX) const
+    void ParticleParticleCollisions::PrepareForBinaryTree() const
     {
         glUseProgram(_programIdGuaranteeSortingDataUniqueness);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildDispatchOffsetBytes());
         glUseProgram(_programIdGenerateLeafNodeBoundingBoxes);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildDispatchOffsetBytes());
 
         // the two shaders worked on independent data, so only need one memory barrier at the end
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
@@ -992,15 +1198,14 @@ namespace ShaderControllers
     /*--------------------------------------------------------------------------------------------
     Description:
         All that sorting to get to here.
-    Parameters: 
-        numWorkGroupsX      Expected to be the number of particles divided by work group size.
+    Parameters: None
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::GenerateBinaryRadixTree(unsigned int numWorkGroupsX) const
+    void ParticleParticleCollisions::GenerateBinaryRadixTree() const
     {
         glUseProgram(_programIdGenerateBinaryRadixTree);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildDispatchOffsetBytes());
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
         //// verify that the binary tree is valid by checking that all parent-child relationships 
@@ -1061,47 +1266,96 @@ namespace ShaderControllers
         And finally the binary radix tree blooms with beautiful bounding boxes into a Bounding 
         Volume Hierarchy.  I'm tired and am thinking of nice "tree in spring" analogy.  The 
         analogy starts to fall apart when I think of creating the tree anew ~60x/sec.  
-    Parameters: 
-        numWorkGroupsX      Expected to be number of particles divided by work group size.
+    Parameters: None
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::MergeNodesIntoBvh(unsigned int numWorkGroupsX) const
+    void ParticleParticleCollisions::MergeNodesIntoBvh() const
     {
         glUseProgram(_programIdMergeBoundingVolumes);
-        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glDispatchComputeIndirect(ParticleNeighbourListReferenceSsbo::RebuildDispatchOffsetBytes());
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
     }
 
     /*--------------------------------------------------------------------------------------------
     Description:
-        Populates the PotentialParticleParticleCollisionsBuffer.
+        Traverses the BVH and gives particles new velocity vectors if they collide.
+
+        Note: If PARTICLE_SOLVER is the contact solver or XPBD, then they do this instead (see 
+        ParticleSolver.comp).
     Parameters: 
         numWorkGroupsX      Expected to be number of particles divided by work group size.
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::DetectCollisions(unsigned int numWorkGroupsX) const
+    void ParticleParticleCollisions::DetectAndResolveCollisions(unsigned int numWorkGroupsX) const
     {
-        glUseProgram(_programIdDetectCollisions);
+#if PARTICLE_SOLVER == PARTICLE_SOLVER_CONTACT
+        DetectAndColourContacts(numWorkGroupsX);
+        SolveContacts(numWorkGroupsX, _programIdSolveContacts, PARTICLE_CONTACT_SOLVER_ITERATIONS);
+#elif PARTICLE_SOLVER == PARTICLE_SOLVER_XPBD
+        DetectAndColourContacts(numWorkGroupsX);
+        SolveContacts(numWorkGroupsX, _programIdProjectContactConstraints, PARTICLE_XPBD_ITERATIONS);
+#else
+        glUseProgram(_programIdDetectAndResolveCollisions);
         glDispatchCompute(numWorkGroupsX, 1, 1);
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+#endif
     }
 
     /*--------------------------------------------------------------------------------------------
     Description:
-        Reads the PotentialParticleParticleCollisionsBuffer and gives particles new velocity vectors if 
-        they collide.
+        The first half of the contact solver and the XPBD solver (see 
+        ParticleContactSolver.comp).  Finds every particle's contacts, then colours the contact 
+        graph.
     Parameters: 
         numWorkGroupsX      Expected to be number of particles divided by work group size.
     Returns:    None
-    Creator:    John Cox, 6/2017
+    Creator:    John Cox, 10/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticleParticleCollisions::ResolveCollisions(unsigned int numWorkGroupsX) const
+    void ParticleParticleCollisions::DetectAndColourContacts(unsigned int numWorkGroupsX) const
     {
-        glUseProgram(_programIdResolveCollisions);
+        glUseProgram(_programIdDetectContacts);
         glDispatchCompute(numWorkGroupsX, 1, 1);
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glUseProgram(_programIdColourContacts);
+        for (unsigned int round = 0; round < NUM_CONTACT_COLOURING_ROUNDS; round++)
+        {
+            glDispatchCompute(numWorkGroupsX, 1, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+    }
+
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        The second half of the contact solver and the XPBD solver.  Sweeps over the colours of 
+        the contact graph.
+
+        Every colour gets a dispatch on every sweep, plus one for the particles that didn't get 
+        a colour, even if there are no particles of that colour.  There is no readback to find 
+        out, and a dispatch where every thread quits right away is cheap.
+    Parameters: 
+        numWorkGroupsX      Expected to be number of particles divided by work group size.
+        programId           Either the contact solver's program or XPBD's.
+        numIterations       Self-explanatory.
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    void ParticleParticleCollisions::SolveContacts(unsigned int numWorkGroupsX, 
+        unsigned int programId, unsigned int numIterations) const
+    {
+        // Note: The last colour is for the particles that didn't get one.
+        glUseProgram(programId);
+        for (unsigned int iteration = 0; iteration < numIterations; iteration++)
+        {
+            for (int colour = 0; colour <= MAX_NUM_CONTACT_COLOURS; colour++)
+            {
+                glUniform1i(UNIFORM_LOCATION_PARTICLE_CONTACT_COLOUR, colour);
+                glDispatchCompute(numWorkGroupsX, 1, 1);
+                glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            }
+        }
     }
 
     /*--------------------------------------------------------------------------------------------
@@ -6,17 +6,19 @@
 
 #include "Shaders/ShaderHeaders/ComputeShaderWorkGroupSizes.comp"
 #include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/Compute/Collisions/ParticlePolygon/CollidablePolygonSdf.comp"
+#include "Shaders/Compute/Collisions/ParticlePolygon/DualTree/ParticlePolygonDualTree.comp"
 
 // for profiling and checking results
 #include "Include/ShaderControllers/ProfilingWaitToFinish.h"
 #include "Include/Buffers/SortingData.h"
 #include "Include/Buffers/Particle.h"
 #include "Include/Buffers/BvhNode.h"
-#include "Include/Buffers/PotentialParticleCollisions.h"
 #include "Include/Geometry/Box2D.h"
 #include "Include/Geometry/PolygonFace.h"
 
 #include <chrono>
+#include <stdio.h>
 #include <fstream>
 #include <iostream>
 using std::cout;
@@ -31,11 +33,14 @@ namespace ShaderControllers
     Parameters:
         blenderObjFilePath      Used to load the geometry.
         particleSsbo        Need the buffer size uniform set for these compute shaders.
+        particlePropertiesUbo   The collision shaders need each particle type's collision 
+                                radius.
     Returns:    None
     Creator:    John Cox, 6/2017
     --------------------------------------------------------------------------------------------*/
     ParticlePolygonCollisions::ParticlePolygonCollisions(
-        const std::string &blenderObjFilePath, const ParticleSsbo::SharedConstPtr particleSsbo) :
+        const std::string &blenderObjFilePath, const ParticleSsbo::SharedConstPtr particleSsbo,
+        const ParticlePropertiesUbo::SharedConstPtr particlePropertiesUbo) :
         _programIdCopyGeometryToCopyBuffer(0),
         _programIdGenerateSortingData(0),
         _programIdPrefixScanStage1(0),
@@ -47,15 +52,24 @@ namespace ShaderControllers
         _programIdGenerateLeafNodeBoundingBoxes(0),
         _programIdGenerateBinaryRadixTree(0),
         _programIdMergeBoundingVolumes(0),
-        _programIdDetectCollisions(0),
-        _programIdResolveCollisions(0),
+        _programIdDetectAndResolveWithBvh(0),
+        _programIdDetectAndResolveBruteForce(0),
+        _programIdDetectAndResolveWithSdf(0),
+        _programIdPrepareDualTreePass(0),
+        _programIdExpandDualTreePairs(0),
+        _programIdDetectAndResolveDualTree(0),
         _programIdGeneratePolygonBoundingBoxGeometry(0),
 
         _collideablePolygonSsbo(blenderObjFilePath),
+        _useBruteForce(!FORCE_PARTICLE_POLYGON_BVH && (USE_PARTICLE_POLYGON_DUAL_TREE == 0) && 
+            (_collideablePolygonSsbo.NumPolygons() <= MAX_POLYGONS_FOR_BRUTE_FORCE)),
+        _sdf(nullptr),
+        _useDualTree(USE_PARTICLE_POLYGON_DUAL_TREE != 0),
         _sortingDataSsbo(_collideablePolygonSsbo.NumPolygons()),
         _prefixSumSsbo(_collideablePolygonSsbo.NumPolygons()),
         _bvhNodeSsbo(_collideablePolygonSsbo.NumPolygons()),
-        _potentialCollisionsSsbo(particleSsbo->NumParticles()),
+        _dualTreePairQueueSsbo(particleSsbo->NumParticles()),
+        _particlePolygonCandidateSsbo(particleSsbo->NumParticles()),
         _boundingBoxGeometrySsbo(_collideablePolygonSsbo.NumPolygons()),
         _surfaceNormalGeometrySsbo(blenderObjFilePath),
         _originalParticleSsbo(particleSsbo)
@@ -70,8 +84,9 @@ namespace ShaderControllers
         _collideablePolygonSsbo.ConfigureConstantUniforms(_programIdGenerateSortingData);
         _collideablePolygonSsbo.ConfigureConstantUniforms(_programIdSortGeometry);
         _collideablePolygonSsbo.ConfigureConstantUniforms(_programIdGenerateLeafNodeBoundingBoxes);
-        _collideablePolygonSsbo.ConfigureConstantUniforms(_programIdDetectCollisions);
-        _collideablePolygonSsbo.ConfigureConstantUniforms(_programIdResolveCollisions);
+        _collideablePolygonSsbo.ConfigureConstantUniforms(_programIdDetectAndResolveWithBvh);
+        _collideablePolygonSsbo.ConfigureConstantUniforms(_programIdDetectAndResolveBruteForce);
+        _collideablePolygonSsbo.ConfigureConstantUniforms(_programIdDetectAndResolveDualTree);
 
         _sortingDataSsbo.ConfigureConstantUniforms(_programIdGenerateSortingData);
         _sortingDataSsbo.ConfigureConstantUniforms(_programIdPrefixScanStage1);
@@ -89,20 +104,66 @@ namespace ShaderControllers
         _bvhNodeSsbo.ConfigureConstantUniforms(_programIdGenerateBinaryRadixTree);
         _bvhNodeSsbo.ConfigureConstantUniforms(_programIdMergeBoundingVolumes);
         _bvhNodeSsbo.ConfigureConstantUniforms(_programIdGeneratePolygonBoundingBoxGeometry);
-        _bvhNodeSsbo.ConfigureConstantUniforms(_programIdDetectCollisions);
+        _bvhNodeSsbo.ConfigureConstantUniforms(_programIdDetectAndResolveWithBvh);
+        _bvhNodeSsbo.ConfigureConstantUniforms(_programIdExpandDualTreePairs);
+        _bvhNodeSsbo.ConfigureConstantUniforms(_programIdDetectAndResolveDualTree);
 
-        _potentialCollisionsSsbo.ConfigureConstantUniforms(_programIdDetectCollisions);
-        _potentialCollisionsSsbo.ConfigureConstantUniforms(_programIdResolveCollisions);
+        _dualTreePairQueueSsbo.ConfigureConstantUniforms(_programIdPrepareDualTreePass);
+        _dualTreePairQueueSsbo.ConfigureConstantUniforms(_programIdExpandDualTreePairs);
+        _dualTreePairQueueSsbo.ConfigureConstantUniforms(_programIdDetectAndResolveDualTree);
+
+        _particlePolygonCandidateSsbo.ConfigureConstantUniforms(_programIdExpandDualTreePairs);
+        _particlePolygonCandidateSsbo.ConfigureConstantUniforms(_programIdDetectAndResolveDualTree);
 
         _boundingBoxGeometrySsbo.ConfigureConstantUniforms(_programIdGeneratePolygonBoundingBoxGeometry);
 
-        particleSsbo->ConfigureConstantUniforms(_programIdDetectCollisions);
-        particleSsbo->ConfigureConstantUniforms(_programIdResolveCollisions);
+        particleSsbo->ConfigureConstantUniforms(_programIdDetectAndResolveWithBvh);
+        particleSsbo->ConfigureConstantUniforms(_programIdDetectAndResolveBruteForce);
+
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdDetectAndResolveWithBvh);
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdDetectAndResolveBruteForce);
+
+        particleSsbo->ConfigureConstantUniforms(_programIdDetectAndResolveWithSdf);
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdDetectAndResolveWithSdf);
+
+        particleSsbo->ConfigureConstantUniforms(_programIdDetectAndResolveDualTree);
+        particlePropertiesUbo->ConfigureConstantUniforms(_programIdDetectAndResolveDualTree);
+
+#if USE_COLLIDABLE_POLYGON_SDF
+        // the field replaces the BVH and brute force
+        _sdf = std::make_shared<CollidablePolygonSdf>(blenderObjFilePath);
+#endif
+
+        // the polygon count can quietly override the flags, so say which path was taken
+        unsigned int numPolygons = _collideablePolygonSsbo.NumPolygons();
+        if (_sdf != nullptr)
+        {
+            printf("particle-polygon collisions: signed distance field for %u polygons\n", numPolygons);
+        }
+        else if (_useBruteForce)
+        {
+            printf("particle-polygon collisions: brute force for %u polygons (<= %u); set FORCE_PARTICLE_POLYGON_BVH to use the BVH\n", 
+                numPolygons, MAX_POLYGONS_FOR_BRUTE_FORCE);
+        }
+        else if (_useDualTree)
+        {
+            printf("particle-polygon collisions: dual tree for %u polygons\n", numPolygons);
+        }
+        else
+        {
+            printf("particle-polygon collisions: BVH for %u polygons\n", numPolygons);
+        }
 
 
         // geometry doesn't move, so its BVH will be static through the life of the program
-        GenerateCollidablePolygonBvh();
-        GenerateBoundingBoxGeometry();
+        // Note: Brute force doesn't use the BVH, so don't bother.  The bounding box geometry is 
+        // generated from the BVH, so it is skipped too and there won't be any boxes to draw.
+        // Also Note: Same for the signed distance field.
+        if (!_useBruteForce && _sdf == nullptr)
+        {
+            GenerateCollidablePolygonBvh();
+            GenerateBoundingBoxGeometry();
+        }
 
 
         printf("");
@@ -131,8 +192,12 @@ namespace ShaderControllers
         glDeleteProgram(_programIdGenerateBinaryRadixTree);
         glDeleteProgram(_programIdMergeBoundingVolumes);
 
-        glDeleteProgram(_programIdDetectCollisions);
-        glDeleteProgram(_programIdResolveCollisions);
+        glDeleteProgram(_programIdDetectAndResolveWithBvh);
+        glDeleteProgram(_programIdDetectAndResolveBruteForce);
+        glDeleteProgram(_programIdDetectAndResolveWithSdf);
+        glDeleteProgram(_programIdPrepareDualTreePass);
+        glDeleteProgram(_programIdExpandDualTreePairs);
+        glDeleteProgram(_programIdDetectAndResolveDualTree);
     }
 
     /*--------------------------------------------------------------------------------------------
@@ -166,26 +231,34 @@ namespace ShaderControllers
 
         if (withProfiling)
         {
-            cout << "detecting collisions for up to " << numParticles << " particles with " << _collideablePolygonSsbo.NumPolygons() << " polygons" << endl;
+            cout << "detecting collisions for up to " << numParticles << " particles with " << _collideablePolygonSsbo.NumPolygons() << " polygons" << (_sdf != nullptr ? " (SDF)" : (_useBruteForce ? " (brute force)" : (_useDualTree ? " (dual tree)" : " (BVH)"))) << endl;
 
             // for profiling
             using namespace std::chrono;
             steady_clock::time_point start;
             steady_clock::time_point end;
-            long long durationDetectCollisions = 0;
-            long long durationResolveCollisions = 0;
-
-            start = high_resolution_clock::now();
-            DetectCollisions(numWorkGroupsX);
-            WaitForComputeToFinish();
-            end = high_resolution_clock::now();
-            durationDetectCollisions = duration_cast<microseconds>(end - start).count();
+            long long durationDetectAndResolve = 0;
 
             start = high_resolution_clock::now();
-            ResolveCollisions(numWorkGroupsX);
+            if (_sdf != nullptr)
+            {
+                DetectAndResolveWithSdf(numWorkGroupsX);
+            }
+            else if (_useBruteForce)
+            {
+                DetectAndResolveBruteForce(numWorkGroupsX);
+            }
+            else if (_useDualTree)
+            {
+                DetectAndResolveDualTree(numWorkGroupsX);
+            }
+            else
+            {
+                DetectAndResolveWithBvh(numWorkGroupsX);
+            }
             WaitForComputeToFinish();
             end = high_resolution_clock::now();
-            durationResolveCollisions = duration_cast<microseconds>(end - start).count();
+            durationDetectAndResolve = duration_cast<microseconds>(end - start).count();
 
             // report the results to file
             // Note: Write the results to a tab-delimited text file so that I can dump them into an 
@@ -193,23 +266,28 @@ namespace ShaderControllers
             std::ofstream outFile("ProfilingDurations/DetectAndResolveParticlePolygonCollisionsDuration.txt");
             if (outFile.is_open())
             {
-                long long totalSortingTime = durationDetectCollisions + durationResolveCollisions;
-
                 cout << "particle-polygon collision handling time:" << endl <<
-                    "\ttotal: " << totalSortingTime << endl <<
-                    "\tdetect collisions: " << durationDetectCollisions << endl <<
-                    "\tresolve collisions: " << durationResolveCollisions << endl;
+                    "\ttotal: " << durationDetectAndResolve << endl;
                 outFile << "particle-polygon collision handling time:" << endl <<
-                    "\ttotal: " << totalSortingTime << endl <<
-                    "\tdetect collisions: " << durationDetectCollisions << endl <<
-                    "\tresolve collisions: " << durationResolveCollisions << endl;
+                    "\ttotal: " << durationDetectAndResolve << endl;
             }
             outFile.close();
         }
+        else if (_sdf != nullptr)
+        {
+            DetectAndResolveWithSdf(numWorkGroupsX);
+        }
+        else if (_useBruteForce)
+        {
+            DetectAndResolveBruteForce(numWorkGroupsX);
+        }
+        else if (_useDualTree)
+        {
+            DetectAndResolveDualTree(numWorkGroupsX);
+        }
         else
         {
-            DetectCollisions(numWorkGroupsX);
-            ResolveCollisions(numWorkGroupsX);
+            DetectAndResolveWithBvh(numWorkGroupsX);
         }
     }
 
@@ -386,19 +464,47 @@ namespace ShaderControllers
         std::string shaderKey;
         std::string filePath;
 
-        shaderKey = "detect particle-polygon collisions";
-        filePath = "Shaders/Compute/Collisions/ParticlePolygon/DetectParticlePolygonCollisions.comp";
+        shaderKey = "detect and resolve particle-polygon collisions with BVH";
+        filePath = "Shaders/Compute/Collisions/ParticlePolygon/DetectAndResolveParticlePolygonCollisions.comp";
         shaderStorageRef.NewShader(shaderKey);
         shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
         shaderStorageRef.LinkShader(shaderKey);
-        _programIdDetectCollisions = shaderStorageRef.GetShaderProgram(shaderKey);
+        _programIdDetectAndResolveWithBvh = shaderStorageRef.GetShaderProgram(shaderKey);
 
-        shaderKey = "resolve particle-polygon collisions";
-        filePath = "Shaders/Compute/Collisions/ParticlePolygon/ResolveParticlePolygonCollisions.comp";
+        shaderKey = "detect and resolve particle-polygon collisions brute force";
+        filePath = "Shaders/Compute/Collisions/ParticlePolygon/DetectAndResolveParticlePolygonCollisionsBruteForce.comp";
         shaderStorageRef.NewShader(shaderKey);
         shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
         shaderStorageRef.LinkShader(shaderKey);
-        _programIdResolveCollisions = shaderStorageRef.GetShaderProgram(shaderKey);
+        _programIdDetectAndResolveBruteForce = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        shaderKey = "detect and resolve particle-polygon collisions with SDF";
+        filePath = "Shaders/Compute/Collisions/ParticlePolygon/DetectAndResolveParticlePolygonCollisionsWithSdf.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdDetectAndResolveWithSdf = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        shaderKey = "prepare dual-tree pass";
+        filePath = "Shaders/Compute/Collisions/ParticlePolygon/DualTree/PrepareDualTreePass.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdPrepareDualTreePass = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        shaderKey = "expand dual-tree pairs";
+        filePath = "Shaders/Compute/Collisions/ParticlePolygon/DualTree/ExpandDualTreePairs.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdExpandDualTreePairs = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        shaderKey = "detect and resolve particle-polygon collisions with dual tree";
+        filePath = "Shaders/Compute/Collisions/ParticlePolygon/DetectAndResolveParticlePolygonCollisionsDualTree.comp";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, filePath, GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _programIdDetectAndResolveDualTree = shaderStorageRef.GetShaderProgram(shaderKey);
     }
 
     /*--------------------------------------------------------------------------------------------
@@ -514,8 +620,8 @@ namespace ShaderControllers
 
     /*--------------------------------------------------------------------------------------------
     Description:
-        This method governs the shader dispatches that fills in the 
-        PotentialParticlePolygonCollisionsBuffer.
+        This method governs the shader dispatch that traverses the collidable polygon BVH for 
+        each particle and bounces the particle off the first polygon that it crossed.
     Parameters: 
         numWorkGroupsX  Expected to be the total particle count divided by work group size.  No, 
                         that is not a typo.  Particle-polygon collision detection uses one 
@@ -523,52 +629,114 @@ namespace ShaderControllers
     Returns:    None
     Creator:    John Cox, 7/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticlePolygonCollisions::DetectCollisions(unsigned int numWorkGroupsX) const
+    void ParticlePolygonCollisions::DetectAndResolveWithBvh(unsigned int numWorkGroupsX) const
     {
-        glUseProgram(_programIdDetectCollisions);
+        glUseProgram(_programIdDetectAndResolveWithBvh);
         glDispatchCompute(numWorkGroupsX, 1, 1);
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
 
-        //// for verifying/debugging
-        //unsigned int startingIndexBytes = 0;
-        //std::vector<PotentialParticleCollisions> checkPotentialCollisions(_potentialCollisionsSsbo.NumItems());
-        //unsigned int bufferSizeBytes = checkPotentialCollisions.size() * sizeof(SortingData);
-        //glBindBuffer(GL_SHADER_STORAGE_BUFFER, _potentialCollisionsSsbo.BufferId());
-        //void *bufferPtr = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, startingIndexBytes, bufferSizeBytes, GL_MAP_READ_BIT);
-        //memcpy(checkPotentialCollisions.data(), bufferPtr, bufferSizeBytes);
-        //glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-        //glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        Used instead of DetectAndResolveWithBvh(...) when there are few enough polygons that 
+        every particle can check every polygon.  No BVH required.
+    Parameters: 
+        numWorkGroupsX  Expected to be the total particle count divided by work group size.
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    void ParticlePolygonCollisions::DetectAndResolveBruteForce(unsigned int numWorkGroupsX) const
+    {
+        glUseProgram(_programIdDetectAndResolveBruteForce);
+        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
 
-        //for (size_t i = 0; i < checkPotentialCollisions.size(); i++)
-        //{
-        //    const PotentialParticleCollisions &potentialCollisions = checkPotentialCollisions[i];
-        //    if (potentialCollisions._numPotentialCollisions != 0)
-        //    {
-        //        printf("");
-        //    }
-        //}
-        //printf("");
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        Used instead of the BVH or brute force when USE_COLLIDABLE_POLYGON_SDF is on.  Each 
+        particle reads the baked signed distance field (see CollidablePolygonSdf) instead of 
+        looking at any polygons.
+    Parameters: 
+        numWorkGroupsX  Expected to be the total particle count divided by work group size.
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    void ParticlePolygonCollisions::DetectAndResolveWithSdf(unsigned int numWorkGroupsX) const
+    {
+        _sdf->BindToTextureUnit();
+        glUseProgram(_programIdDetectAndResolveWithSdf);
+        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
     }
 
     /*--------------------------------------------------------------------------------------------
     Description:
-        This method governs the shader dispatches that will result in particles that collide
-        with the collidable polygons receiving new position, previous position, and velocity
-        vectors.
+        Used instead of DetectAndResolveWithBvh(...) when USE_PARTICLE_POLYGON_DUAL_TREE is on.  
+        The particle BVH and the polygon BVH are walked together, one level per pass, to make 
+        each particle's list of candidate polygons, and then each particle only checks its 
+        candidates (see ParticlePolygonDualTree.comp).
+
+        Note: The particle BVH is the one that ParticleParticleCollisions built this frame.  Its 
+        buffer binding is global, so it is already bound.  Particle-particle collision 
+        resolution may have moved particles a little since then, so a particle whose path isn't 
+        in its leaf box any more might miss a candidate this frame, but the same is true of 
+        particle-particle collisions (see ParticleBvhTraversal.comp).
     Parameters: 
-        numWorkGroupsX  Expected to be the total particle count divided by work group size.  No, 
-                        that is not a typo.  Particle-polygon collision detection uses one 
-                        thread per particle, NOT per polygon.
+        numWorkGroupsX  Expected to be the total particle count divided by work group size.
     Returns:    None
-    Creator:    John Cox, 7/2017
+    Creator:    John Cox, 10/2017
     --------------------------------------------------------------------------------------------*/
-    void ParticlePolygonCollisions::ResolveCollisions(unsigned int numWorkGroupsX) const
+    void ParticlePolygonCollisions::DetectAndResolveDualTree(unsigned int numWorkGroupsX) const
     {
-        glUseProgram(_programIdResolveCollisions);
+        // particle BVH root is after all the particle leaves, and same for the polygon BVH
+        int particleRootNodeIndex = static_cast<int>(_originalParticleSsbo->NumParticles());
+        int polygonRootNodeIndex = static_cast<int>(_collideablePolygonSsbo.NumPolygons());
+        _dualTreePairQueueSsbo.StartWithRootPair(particleRootNodeIndex, polygonRootNodeIndex);
+
+        // the indirect dispatch arguments are in the pair queue's header
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, _dualTreePairQueueSsbo.BufferId());
+        for (unsigned int passNumber = 0; passNumber < MAX_DUAL_TREE_PASSES; passNumber++)
+        {
+            ExpandDualTreePairs(passNumber);
+        }
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+
+        glUseProgram(_programIdDetectAndResolveDualTree);
         glDispatchCompute(numWorkGroupsX, 1, 1);
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
     }
 
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        One level of the dual-tree traversal.  The first dispatch is a single thread that turns 
+        the last pass' pair count into this pass' dispatch size, and then the pairs are expanded 
+        with an indirect dispatch of that size.
+
+        Note: The pair queue has two halves.  Each pass reads the half that the last pass wrote 
+        to and writes to the other, the same as the sorting data during a radix sort.
+    Parameters: 
+        passNumber  Used to pick which half of the pair queue is read and which is written.
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    void ParticlePolygonCollisions::ExpandDualTreePairs(unsigned int passNumber) const
+    {
+        unsigned int halfSize = _dualTreePairQueueSsbo.HalfSize();
+        unsigned int readOffset = (passNumber % 2 == 0) ? 0 : halfSize;
+        unsigned int writeOffset = (passNumber % 2 == 0) ? halfSize : 0;
+
+        glUseProgram(_programIdPrepareDualTreePass);
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+        glUseProgram(_programIdExpandDualTreePairs);
+        glUniform1ui(UNIFORM_LOCATION_DUAL_TREE_PAIR_QUEUE_READ_OFFSET, readOffset);
+        glUniform1ui(UNIFORM_LOCATION_DUAL_TREE_PAIR_QUEUE_WRITE_OFFSET, writeOffset);
+        glDispatchComputeIndirect(DualTreePairQueueSsbo::IndirectDispatchOffsetBytes());
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
     /*--------------------------------------------------------------------------------------------
     Description:
         This method governs the shader dispatches that generates geometry out of the polygon bounding boxes
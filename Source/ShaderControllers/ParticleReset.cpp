@@ -1,13 +1,17 @@
 #include "Include/ShaderControllers/ParticleReset.h"
 
+#include <algorithm>
+#include <stdio.h>
 #include <string>
+#include <vector>
 
-#include "Include/Buffers/PersistentAtomicCounterBuffer.h"
 #include "Shaders/ShaderStorage.h"
-#include "Shaders/ShaderHeaders/ComputeShaderWorkGroupSizes.comp"
+#include "Include/ParticleEmitters/ParticleRandom.h"
 
 #include "ThirdParty/glload/include/glload/gl_4_4.h"
-#include "ThirdParty/glm/gtc/type_ptr.hpp"
+#include "Shaders/ShaderHeaders/CrossShaderUniformLocations.comp"
+#include "Shaders/ShaderHeaders/SsboBufferBindings.comp"
+#include "Shaders/Compute/ParticleReset/RandomSeed.comp"
 
 
 //#include "Include/Buffers/Particle.h"
@@ -20,9 +24,11 @@ namespace ShaderControllers
     Description:
         Gives members initial values.
         
-        Constructs the ParticleResetPoint and ParticleResetBar compute shaders out of the 
-        necessary shader pieces.
-        Looks up all uniforms in the resultant shaders.
+        Constructs the emission compute shader and the one that hands out inactive particles to 
+        the emitters out of the necessary shader pieces.
+
+        If CHECK_RANDOM_MIRROR_ON_STARTUP is on (see RandomSeed.comp), also checks that the CPU 
+        mirror of the random numbers still matches the GPU (see CheckRandomMirror()).
     Parameters: 
         ssboToReset     ParticleUpdate will tell the SSBO to configure its buffer size 
                         uniforms for the compute shader.
@@ -30,60 +36,38 @@ namespace ShaderControllers
     Creator:    John Cox, 4/2017
     ----------------------------------------------------------------------------------------*/
     ParticleReset::ParticleReset(const ParticleSsbo::SharedConstPtr &ssboToReset) :
-        _totalParticleCount(0),
-        _computeProgramIdBarEmitters(0),
-        _computeProgramIdPointEmitters(0),
-        _unifLocPointEmitterCenter(-1),
-        _unifLocPointMaxParticleEmitCount(-1),
-        _unifLocPointMinParticleVelocity(-1),
-        _unifLocPointMaxParticleVelocity(-1),
-        _unifLocBarEmitterP1(-1),
-        _unifLocBarEmitterP2(-1),
-        _unifLocBarEmitterEmitDir(-1),
-        _unifLocBarMaxParticleEmitCount(-1),
-        _unifLocBarMinParticleVelocity(-1),
-        _unifLocBarMaxParticleVelocity(-1)
+        _computeProgramIdEmitters(0),
+        _computeProgramIdPrepareEmission(0),
+        _randomFrame(0),
+        _maxEmissionSpeed(0.0f),
+        _freeListSsbo(ssboToReset->NumParticles())
     {
         //particleSsbo = ssboToReset;
 
-        _totalParticleCount = ssboToReset->NumVertices();
-
         // construct the compute shader
         ShaderStorage &shaderStorageRef = ShaderStorage::GetInstance();
         std::string shaderKey;
 
-        // first make the particle reset shader for point emitters
-        shaderKey = "particle reset point emitter";
+        // first make the particle reset shader for all the emitters
+        shaderKey = "particle reset emitters";
         shaderStorageRef.NewShader(shaderKey);
-        shaderStorageRef.AddAndCompileShaderFile(shaderKey, "Shaders/Compute/ParticleReset/ParticleResetPointEmitter.comp", GL_COMPUTE_SHADER);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, "Shaders/Compute/ParticleReset/ParticleResetEmitters.comp", GL_COMPUTE_SHADER);
         shaderStorageRef.LinkShader(shaderKey);
-        _computeProgramIdPointEmitters = shaderStorageRef.GetShaderProgram(shaderKey);
-        ssboToReset->ConfigureConstantUniforms(_computeProgramIdPointEmitters);
-
-        // uniform lookups for the point emitter shader
-        _unifLocPointEmitterCenter = shaderStorageRef.GetUniformLocation(shaderKey, "uPointEmitterCenter");
-        _unifLocPointMaxParticleEmitCount = shaderStorageRef.GetUniformLocation(shaderKey, "uMaxParticleEmitCount");
-        _unifLocPointMinParticleVelocity = shaderStorageRef.GetUniformLocation(shaderKey, "uMinParticleVelocity");
-        _unifLocPointMaxParticleVelocity = shaderStorageRef.GetUniformLocation(shaderKey, "uMaxParticleVelocity");
+        _computeProgramIdEmitters = shaderStorageRef.GetShaderProgram(shaderKey);
+        ssboToReset->ConfigureConstantUniforms(_computeProgramIdEmitters);
 
-        // now for the bar emitters
-        shaderKey = "particle reset bar emitter";
+        // and the one that hands out inactive particles to them
+        shaderKey = "prepare particle emission";
         shaderStorageRef.NewShader(shaderKey);
-        shaderStorageRef.AddAndCompileShaderFile(shaderKey, "Shaders/Compute/ParticleReset/ParticleResetBarEmitter.comp", GL_COMPUTE_SHADER);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, "Shaders/Compute/ParticleReset/PrepareParticleEmission.comp", GL_COMPUTE_SHADER);
         shaderStorageRef.LinkShader(shaderKey);
-        _computeProgramIdBarEmitters = shaderStorageRef.GetShaderProgram(shaderKey);
-        ssboToReset->ConfigureConstantUniforms(_computeProgramIdBarEmitters);
-
-        // uniform lookups for the bar emitter shader
-        // Note: This also requires a "min velocity between min and max".
-        _unifLocBarEmitterP1 = shaderStorageRef.GetUniformLocation(shaderKey, "uBarEmitterP1");
-        _unifLocBarEmitterP2 = shaderStorageRef.GetUniformLocation(shaderKey, "uBarEmitterP2");
-        _unifLocBarEmitterEmitDir = shaderStorageRef.GetUniformLocation(shaderKey, "uBarEmitterEmitDir");
-        _unifLocBarMaxParticleEmitCount = shaderStorageRef.GetUniformLocation(shaderKey, "uMaxParticleEmitCount");
-        _unifLocBarMinParticleVelocity = shaderStorageRef.GetUniformLocation(shaderKey, "uMinParticleVelocity");
-        _unifLocBarMaxParticleVelocity = shaderStorageRef.GetUniformLocation(shaderKey, "uMaxParticleVelocity");
-
-        // uniform values are set in ResetParticles(...)
+        _computeProgramIdPrepareEmission = shaderStorageRef.GetShaderProgram(shaderKey);
+
+#if CHECK_RANDOM_MIRROR_ON_STARTUP
+        CheckRandomMirror();
+#endif
+
+        // the emitters are uploaded in ResetParticles(...)
     }
     
     /*--------------------------------------------------------------------------------------------
@@ -95,8 +79,8 @@ namespace ShaderControllers
     --------------------------------------------------------------------------------------------*/
     ParticleReset::~ParticleReset()
     {
-        glDeleteProgram(_computeProgramIdBarEmitters);
-        glDeleteProgram(_computeProgramIdPointEmitters);
+        glDeleteProgram(_computeProgramIdEmitters);
+        glDeleteProgram(_computeProgramIdPrepareEmission);
     }
 
     /*--------------------------------------------------------------------------------------------
@@ -129,12 +113,18 @@ namespace ShaderControllers
 
     /*--------------------------------------------------------------------------------------------
     Description:
-        Dispatches a shader for each emitter, resetting up to particlesPerEmitterPerFrame for 
-        each emitter.
+        Resets up to particlesPerEmitterPerFrame for each emitter.
 
         Particles are spread out evenly between all the emitters (or at least as best as 
         possible; technically the first emitter gets first dibs at the inactive particles, then 
         the second emitter, etc.).
+
+        Note: This used to be a handful of uniforms, a dispatch, and a barrier for every 
+        emitter.  Now it is one upload, two dispatches, and two barriers no matter how many 
+        emitters there are.
+        (1) PrepareParticleEmission.comp pops the inactive particles off the free list and 
+            hands them out to the emitters
+        (2) ParticleResetEmitters.comp resets them, all emitters at once
     Parameters:    
         particlesPerEmitterPerFrame     Limits the number of particles that are reset per frame 
                                         so that they don't all spawn at once.
@@ -145,65 +135,71 @@ namespace ShaderControllers
     --------------------------------------------------------------------------------------------*/
     void ParticleReset::ResetParticles(unsigned int particlesPerEmitterPerFrame)
     {
+        _maxEmissionSpeed = 0.0f;
         if (_pointEmitters.empty() && _barEmitters.empty())
         {
             // nothing to do
             return;
         }
 
-        // spreading the particles evenly between multiple emitters is done by letting all the 
-        // particle emitters have a go at all the inactive particles
-        // Note: Yes, this algorithm is such that emitters resetting particles have to travers 
-        // through the entire particle collection, but there isn't a way of telling the CPU 
-        // where they were when the last particle was reset.  Also, after the "particles per 
-        // emitter per frame" limit is reached, the vast majority of the threads will simply 
-        // return, so it's actually pretty fast.
-        GLuint numWorkGroupsX = (_totalParticleCount / WORK_GROUP_SIZE_X) + 1;
-        GLuint numWorkGroupsY = 1;
-        GLuint numWorkGroupsZ = 1;
-
-        // give all point emitters a chance to reactivate inactive particles at their positions
-        glUseProgram(_computeProgramIdPointEmitters);
-        glUniform1ui(_unifLocPointMaxParticleEmitCount, particlesPerEmitterPerFrame);
+        // flatten the emitters
+        // Note: The emitters can be moved around at runtime, so this is done every frame.
+        _emitterDescriptors.clear();
         for (size_t pointEmitterCount = 0; pointEmitterCount < _pointEmitters.size(); pointEmitterCount++)
         {
-            // reset everything necessary to control the emission parameters for this emitter
-            // Note: This atomic counter is used to enforce the number of emitted particles per 
-            // emitter per frame 
-            PersistentAtomicCounterBuffer::GetInstance().ResetCounter();
-            ParticleEmitterPoint::CONST_SHARED_PTR &emitter = _pointEmitters[pointEmitterCount];
-
-            glUniform1f(_unifLocPointMinParticleVelocity, emitter->GetMinVelocity());
-            glUniform1f(_unifLocPointMaxParticleVelocity, emitter->GetMaxVelocity());
-            glUniform4fv(_unifLocPointEmitterCenter, 1, glm::value_ptr(emitter->GetPos()));
-
-            // compute ALL the resets! (then make the results visible to the next use of the 
-            // SSBO and to vertext buffer)
-            glDispatchCompute(numWorkGroupsX, numWorkGroupsY, numWorkGroupsZ);
-            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT);
+            const ParticleEmitterPoint::CONST_SHARED_PTR &emitter = _pointEmitters[pointEmitterCount];
+            ParticleEmitterDescriptor descriptor;
+            descriptor._p1 = emitter->GetPos();
+            descriptor._minVel = emitter->GetMinVelocity();
+            descriptor._maxVel = emitter->GetMaxVelocity();
+            descriptor._emitterType = ParticleEmitterDescriptor::EmitterType::POINT;
+            descriptor._particleTypeIndex = emitter->GetParticleTypeIndex();
+            descriptor._maxEmitCount = particlesPerEmitterPerFrame;
+            _emitterDescriptors.push_back(descriptor);
         }
 
-        // and now for any bar emitters
-        glUseProgram(_computeProgramIdBarEmitters);
-        glUniform1ui(_unifLocBarMaxParticleEmitCount, particlesPerEmitterPerFrame);
         for (size_t barEmitterCount = 0; barEmitterCount < _barEmitters.size(); barEmitterCount++)
         {
-            PersistentAtomicCounterBuffer::GetInstance().ResetCounter();
-            ParticleEmitterBar::CONST_SHARED_PTR &emitter = _barEmitters[barEmitterCount];
-
-            glUniform1f(_unifLocBarMinParticleVelocity, emitter->GetMinVelocity());
-            glUniform1f(_unifLocBarMaxParticleVelocity, emitter->GetMaxVelocity());
+            const ParticleEmitterBar::CONST_SHARED_PTR &emitter = _barEmitters[barEmitterCount];
+            ParticleEmitterDescriptor descriptor;
+            descriptor._p1 = emitter->GetBarStart();
+            descriptor._p2 = emitter->GetBarEnd();
+            descriptor._emitDir = emitter->GetEmitDir();
+            descriptor._minVel = emitter->GetMinVelocity();
+            descriptor._maxVel = emitter->GetMaxVelocity();
+            descriptor._emitterType = ParticleEmitterDescriptor::EmitterType::BAR;
+            descriptor._particleTypeIndex = emitter->GetParticleTypeIndex();
+            descriptor._maxEmitCount = particlesPerEmitterPerFrame;
+            _emitterDescriptors.push_back(descriptor);
+        }
 
-            // each bar needs to upload three position vectors (p1, p2, and emit direction)
-            glUniform4fv(_unifLocBarEmitterP1, 1, glm::value_ptr(emitter->GetBarStart()));
-            glUniform4fv(_unifLocBarEmitterP2, 1, glm::value_ptr(emitter->GetBarEnd()));
-            glUniform4fv(_unifLocBarEmitterEmitDir, 1, glm::value_ptr(emitter->GetEmitDir()));
+        _emitterSsbo.Upload(_emitterDescriptors);
 
-            // MOAR resets!
-            glDispatchCompute(numWorkGroupsX, numWorkGroupsY, numWorkGroupsZ);
-            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT);
+        // Note: The CPU doesn't know how many particles the free list will give each emitter, 
+        // so assume that every one of them emitted.
+        for (size_t descriptorIndex = 0; descriptorIndex < _emitterDescriptors.size(); descriptorIndex++)
+        {
+            _maxEmissionSpeed = std::max(_maxEmissionSpeed, _emitterDescriptors[descriptorIndex]._maxVel);
         }
 
+        // hand out the inactive particles
+        // Note: The emission dispatch reads its size from the free list, so the barrier has to 
+        // include GL_COMMAND_BARRIER_BIT.
+        glUseProgram(_computeProgramIdPrepareEmission);
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+        // compute ALL the resets! (then make the results visible to the next use of the SSBO 
+        // and to vertext buffer)
+        // Note: The frame goes up even if nothing was emitted.  It doesn't matter, and this way 
+        // the frame is simply "how many times has this been called".
+        glUseProgram(_computeProgramIdEmitters);
+        glUniform1ui(UNIFORM_LOCATION_PARTICLE_RANDOM_FRAME, _randomFrame++);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, _freeListSsbo.BufferId());
+        glDispatchComputeIndirect(ParticleFreeListSsbo::IndirectDispatchOffsetBytes());
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
         //unsigned int startingIndexBytes = 0;
         //std::vector<Particle> checkResetParticles(particleSsbo->NumParticles());
         //unsigned int bufferSizeBytes = checkResetParticles.size() * sizeof(Particle);
@@ -225,5 +221,83 @@ namespace ShaderControllers
         glUseProgram(0);
     }
 
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        A simple getter for the largest maximum velocity of any emitter on the last 
+        ResetParticles(...) call, or 0 if there weren't any.  The particles that were just 
+        emitted can be no faster than this, and unlike the GPU's measurement of the fastest 
+        particle, the CPU knows it right away (see ParticleUpdate::ChooseNumSubSteps(...)).
+    Parameters: None
+    Returns:    
+        See Description.
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    float ParticleReset::MaxEmissionSpeed() const
+    {
+        return _maxEmissionSpeed;
+    }
+
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        Has CheckRandomMirror.comp generate a few streams of random numbers and compares them 
+        bit for bit against ParticleRandom.  If someone changes one side of Random.comp and 
+        ParticleRandom but not the other, then this says so on startup instead of the CPU 
+        quietly reproducing the wrong particles.
+
+        The program and the buffer are only needed once, so they are made and thrown away here.  
+        The program belongs to ShaderStorage, so ShaderStorage deletes it.
+
+        Note: This waits on the GPU to read the numbers back, but it only happens once.
+    Parameters: None
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    void ParticleReset::CheckRandomMirror() const
+    {
+        ShaderStorage &shaderStorageRef = ShaderStorage::GetInstance();
+        std::string shaderKey = "check random mirror";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, "Shaders/Compute/ParticleReset/CheckRandomMirror.comp", GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        unsigned int programId = shaderStorageRef.GetShaderProgram(shaderKey);
+
+        std::vector<float> gpuValues(RANDOM_MIRROR_CHECK_NUM_STREAMS * RANDOM_MIRROR_CHECK_NUMBERS_PER_STREAM);
+        unsigned int bufferSizeBytes = gpuValues.size() * sizeof(float);
+        unsigned int bufferId = 0;
+        glGenBuffers(1, &bufferId);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferId);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, bufferSizeBytes, 0, GL_STATIC_READ);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, RANDOM_MIRROR_CHECK_BUFFER_BINDING, bufferId);
+
+        glUseProgram(programId);
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glUseProgram(0);
 
+        // Note: The shader wrote the floats' bit patterns, so they can be copied straight into 
+        // floats.
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bufferSizeBytes, gpuValues.data());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, RANDOM_MIRROR_CHECK_BUFFER_BINDING, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glDeleteBuffers(1, &bufferId);
+        shaderStorageRef.DeleteShader(shaderKey);
+
+        // seed each stream the same way as the shader does
+        for (unsigned int streamIndex = 0; streamIndex < RANDOM_MIRROR_CHECK_NUM_STREAMS; streamIndex++)
+        {
+            ParticleRandom random(streamIndex % 4, streamIndex, streamIndex / 4);
+            for (unsigned int numberIndex = 0; numberIndex < RANDOM_MIRROR_CHECK_NUMBERS_PER_STREAM; numberIndex++)
+            {
+                float cpuValue = ((numberIndex % 2) == 0) ? 
+                    random.OnRange0To1() : random.OnRangeNeg1ToPos1();
+                float gpuValue = gpuValues[(streamIndex * RANDOM_MIRROR_CHECK_NUMBERS_PER_STREAM) + numberIndex];
+                if (cpuValue != gpuValue)
+                {
+                    fprintf(stderr, "ParticleRandom doesn't match Random.comp: stream %u, number %u, CPU %f, GPU %f\n", 
+                        streamIndex, numberIndex, cpuValue, gpuValue);
+                    return;
+                }
+            }
+        }
+    }
 }
@@ -1,10 +1,14 @@
 #include "Include/ShaderControllers/ParticleUpdate.h"
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 
 #include "Include/Buffers/PersistentAtomicCounterBuffer.h"
 #include "Shaders/ShaderStorage.h"
 #include "Shaders/ShaderHeaders/ComputeShaderWorkGroupSizes.comp"
+#include "Shaders/Compute/DemoScene.comp"
+#include "Shaders/Compute/SubStepping.comp"
 
 #include "ThirdParty/glload/include/glload/gl_4_4.h"
 #include "ThirdParty/glm/gtc/type_ptr.hpp"
@@ -25,16 +29,24 @@ namespace ShaderControllers
     Parameters: 
         ssboToUpdate    ParticleUpdate will tell the SSBO to configure its buffer size uniforms 
                         for the compute shader.
+        particlePropertiesUbo   The sub-step count depends on each particle type's collision 
+                                radius.
         particleRegionCenter    Used in conjunction with radius to tell when a particle goes 
         particleRegionRedius    out of bounds.
     Returns:    None
     Creator:    John Cox, 4/2017
     --------------------------------------------------------------------------------------------*/
-    ParticleUpdate::ParticleUpdate(const ParticleSsbo::SharedConstPtr &ssboToUpdate) :
+    ParticleUpdate::ParticleUpdate(const ParticleSsbo::SharedConstPtr &ssboToUpdate, const ParticlePropertiesUbo::SharedConstPtr &particlePropertiesUbo) :
         _totalParticleCount(0),
         _activeParticleCount(0),
         _computeProgramId(0),
-        _unifLocDeltaTimeSec(-1)
+        _unifLocDeltaTimeSec(-1),
+        _deriveVelocityProgramId(0),
+        _unifLocDeriveVelocityDeltaTimeSec(-1),
+        _measureMaxSpeedProgramId(0),
+        _numSubSteps(1),
+        _maxSpeedInRadii(0.0f),
+        _minCollisionRadius(particlePropertiesUbo->MinCollisionRadius())
     {
         //particleSsbo = ssboToUpdate;
 
@@ -49,10 +61,28 @@ namespace ShaderControllers
         shaderStorageRef.LinkShader(shaderKey);
         _computeProgramId = shaderStorageRef.GetShaderProgram(shaderKey);
         ssboToUpdate->ConfigureConstantUniforms(_computeProgramId);
+        particlePropertiesUbo->ConfigureConstantUniforms(_computeProgramId);
 
         _unifLocDeltaTimeSec = shaderStorageRef.GetUniformLocation(shaderKey, "uDeltaTimeSec");
 
-        // delta time set in Update(...)
+        shaderKey = "derive particle velocity from positions";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, "Shaders/Compute/DeriveVelocityFromPositions.comp", GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _deriveVelocityProgramId = shaderStorageRef.GetShaderProgram(shaderKey);
+        ssboToUpdate->ConfigureConstantUniforms(_deriveVelocityProgramId);
+
+        _unifLocDeriveVelocityDeltaTimeSec = shaderStorageRef.GetUniformLocation(shaderKey, "uDeltaTimeSec");
+
+        shaderKey = "measure max particle speed";
+        shaderStorageRef.NewShader(shaderKey);
+        shaderStorageRef.AddAndCompileShaderFile(shaderKey, "Shaders/Compute/MeasureMaxParticleSpeed.comp", GL_COMPUTE_SHADER);
+        shaderStorageRef.LinkShader(shaderKey);
+        _measureMaxSpeedProgramId = shaderStorageRef.GetShaderProgram(shaderKey);
+        ssboToUpdate->ConfigureConstantUniforms(_measureMaxSpeedProgramId);
+        particlePropertiesUbo->ConfigureConstantUniforms(_measureMaxSpeedProgramId);
+
+        // delta time set in Update(...) and DeriveVelocities(...)
     }
 
     /*--------------------------------------------------------------------------------------------
@@ -65,12 +95,15 @@ namespace ShaderControllers
     ParticleUpdate::~ParticleUpdate()
     {
         glDeleteProgram(_computeProgramId);
+        glDeleteProgram(_deriveVelocityProgramId);
+        glDeleteProgram(_measureMaxSpeedProgramId);
     }
 
     /*--------------------------------------------------------------------------------------------
     Description:
-        Resets the "num active particles" atomic counter, dispatches the shader, and reads the 
-        number of active particles after the shader finished.
+        Resets the "num active particles" atomic counter, dispatches the shader, and queues a 
+        readback of the counter.  The number of active particles is then taken from whichever 
+        readback has most recently finished, so this never waits on the GPU.
     
         The number of work groups is based on the maximum number of particles.
     Parameters:    
@@ -99,9 +132,9 @@ namespace ShaderControllers
 
         // the results of the moved particles need to be visible to the next compute shader that 
         // accesses the buffer, vertex data sourced from the particle buffer need to reflect the 
-        // updated movements, and reads from atomic counters must be visible as well (for number 
-        // of active particles)
-        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT);
+        // updated movements, and the counter must be done before it is copied for readback
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+        PersistentAtomicCounterBuffer::GetInstance().QueueCounterReadback();
 
         // cleanup
         glUseProgram(0);
@@ -124,14 +157,97 @@ namespace ShaderControllers
         //}
 
 
-        // now that all active particles have updated, check how many active particles exist 
+        // Note: This is from a few updates ago (see PersistentAtomicCounterBuffer::GetCounterValue()).
         _activeParticleCount = PersistentAtomicCounterBuffer::GetInstance().GetCounterValue();
     }
 
     /*--------------------------------------------------------------------------------------------
     Description:
-        A simple getter for the number of particles that were active on the last Update(...) 
-        call.
+        Only for the XPBD solver (see ParticleSolver.comp).  After the collision constraints 
+        have moved the particles' predicted positions, this sets each particle's velocity to 
+        how fast it had to go to get from its previous position to where it ended up.
+
+        Must be called after all the collision handling for the frame.
+    Parameters:    
+        deltaTimeSec    Must be the same as was given to Update(...).
+    Returns:    None
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    void ParticleUpdate::DeriveVelocities(float deltaTimeSec)
+    {
+        // Note: +1 for the same reason as in Update(...).
+        GLuint numWorkGroupsX = (_totalParticleCount / WORK_GROUP_SIZE_X) + 1;
+
+        glUseProgram(_deriveVelocityProgramId);
+        glUniform1f(_unifLocDeriveVelocityDeltaTimeSec, deltaTimeSec);
+        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+        glUseProgram(0);
+    }
+
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        Measures the fastest particle and decides how many sub-steps this frame needs so that 
+        no particle moves more than MAX_SUB_STEP_TRAVEL_IN_RADII of its own radius in one 
+        sub-step (see SubStepping.comp).  Update(...) and the collision handling should then be 
+        called that many times with deltaTimeSec divided by the result.
+
+        Must be called after the particles are reset for the frame so that the new ones are 
+        measured too.
+
+        Note: This doesn't wait on the GPU.  The measured speed is the newest one that has 
+        finished reading back (see ParticleMaxSpeedSsbo::GetMaxSpeedInRadiiSqr()), which is 
+        usually last frame's.  On its own, that would give a burst of emission its sub-steps a 
+        frame late, so the fastest speed that anything could have been emitted at this frame 
+        is folded in on the CPU.  It is divided by the smallest collision radius because the 
+        CPU doesn't know which types were emitted, so it may over-estimate, but it never 
+        under-estimates.  
+        
+        Also Note: Something that speeds up without being emitted (a light particle hit by a 
+        heavy one, or a strong attractor) still gets its sub-steps a frame late.  Continuous 
+        collision detection still catches the first thing in its way during that frame.
+
+        Also Also Note: The fastest speed is measured even if USE_ADAPTIVE_SUB_STEPPING is off 
+        so that it can be shown on screen (see MaxSpeedInRadii()).  It is one small dispatch and 
+        it doesn't wait on the GPU.
+    Parameters:    
+        deltaTimeSec        How much time the whole frame covers.
+        maxEmissionSpeed    The fastest that any particle was emitted at this frame (see 
+                            ParticleReset::MaxEmissionSpeed()).
+    Returns:    
+        The number of sub-steps, 1 - MAX_SUB_STEPS.
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    unsigned int ParticleUpdate::ChooseNumSubSteps(float deltaTimeSec, float maxEmissionSpeed)
+    {
+        // Note: +1 for the same reason as in Update(...).
+        GLuint numWorkGroupsX = (_totalParticleCount / WORK_GROUP_SIZE_X) + 1;
+
+        _maxSpeedSsbo.Reset();
+        glUseProgram(_measureMaxSpeedProgramId);
+        glDispatchCompute(numWorkGroupsX, 1, 1);
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glUseProgram(0);
+        _maxSpeedSsbo.QueueReadback();
+
+        _maxSpeedInRadii = sqrtf(_maxSpeedSsbo.GetMaxSpeedInRadiiSqr());
+        _maxSpeedInRadii = std::max(_maxSpeedInRadii, maxEmissionSpeed / _minCollisionRadius);
+
+#if USE_ADAPTIVE_SUB_STEPPING
+        // the fastest particle travels this many of its own radii over the whole frame
+        float maxTravelInRadii = _maxSpeedInRadii * deltaTimeSec;
+        float numSubSteps = ceilf(maxTravelInRadii / MAX_SUB_STEP_TRAVEL_IN_RADII);
+        _numSubSteps = static_cast<unsigned int>(std::min(std::max(numSubSteps, 1.0f), static_cast<float>(MAX_SUB_STEPS)));
+#else
+        _numSubSteps = 1;
+#endif
+        return _numSubSteps;
+    }
+
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        A simple getter for the number of particles that were active as of the newest counter 
+        readback that has finished.  That is usually a few Update(...) calls behind.
         
         Useful for performance comparison with CPU version.
     Parameters: None
@@ -143,4 +259,51 @@ namespace ShaderControllers
         return _activeParticleCount;
     }
 
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        A simple getter for the number of sub-steps that were chosen on the last 
+        ChooseNumSubSteps(...) call.
+    Parameters: None
+    Returns:    
+        See Description.
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    unsigned int ParticleUpdate::NumSubSteps() const
+    {
+        return _numSubSteps;
+    }
+
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        A simple getter for the fastest particle's speed, in its own collision radii per 
+        second, that the last ChooseNumSubSteps(...) call worked with.
+    Parameters: None
+    Returns:    
+        See Description.
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    float ParticleUpdate::MaxSpeedInRadii() const
+    {
+        return _maxSpeedInRadii;
+    }
+
+    /*--------------------------------------------------------------------------------------------
+    Description:
+        Adds a force field that will act on every particle from the next Update(...) on.
+
+        Note: The sub-step count is chosen from the particles' speed at the start of the frame, 
+        so a strong field can speed particles up past what the sub-steps were chosen for.  It 
+        catches up on the next frame.
+    Parameters:    
+        forceField  Self-explanatory.
+    Returns:    
+        False if there are already MAX_PARTICLE_FORCE_FIELDS (see ParticleForceFields.comp), 
+        otherwise true.
+    Creator:    John Cox, 10/2017
+    --------------------------------------------------------------------------------------------*/
+    bool ParticleUpdate::AddForceField(const ParticleForceField &forceField)
+    {
+        return _forceFieldUbo.AddForceField(forceField);
+    }
+
 }
@@ -47,7 +47,7 @@
 
 #include "Include/Buffers/Particle.h"
 #include "Include/Buffers/SSBOs/ParticleSsbo.h"
-#include "Include/Buffers/SSBOs/ParticleParticleCollisions/ParticlePropertiesSsbo.h"
+#include "Include/Buffers/ParticlePropertiesUbo.h"
 #include "Include/Buffers/PersistentAtomicCounterBuffer.h"
 #include "Include/ShaderControllers/ParticleReset.h"
 #include "Include/ShaderControllers/ParticleUpdate.h"
@@ -55,6 +55,8 @@
 #include "Include/ShaderControllers/RenderParticles.h"
 #include "Include/ShaderControllers/RenderGeometry.h"
 #include "Include/ShaderControllers/ParticlePolygonCollisions.h"
+#include "Shaders/Compute/DemoScene.comp"
+#include "Shaders/Compute/ParticleSolver.comp"
 
 // for the frame rate counter (and other profiling)
 #include "Include/ShaderControllers/ProfilingWaitToFinish.h"
@@ -65,7 +67,7 @@ Stopwatch gTimer;
 FreeTypeEncapsulated gTextAtlases;
 
 ParticleSsbo::SharedPtr particleBuffer = nullptr;
-ParticlePropertiesSsbo::SharedPtr particlePropertiesBuffer = nullptr;
+ParticlePropertiesUbo::SharedPtr particlePropertiesUbo = nullptr;
 std::shared_ptr<ShaderControllers::ParticleReset> particleResetter = nullptr;
 std::shared_ptr<ShaderControllers::ParticleUpdate> particleUpdater = nullptr;
 std::shared_ptr<ShaderControllers::ParticleParticleCollisions> particleCollisions = nullptr;
@@ -136,17 +138,50 @@ void GenerateParticleEmitters()
     glm::vec2 bar1P1(-0.8f, -0.8f);
     glm::vec2 bar1P2(-0.8f, +0.8f);
     glm::vec2 emitDir1(+1.0f, +0.0f);
-    ParticleEmitterBar::SHARED_PTR barEmitter1 = std::make_shared<ParticleEmitterBar>(bar1P1, bar1P2, emitDir1, particleMinVel, particleMaxVel);
+    ParticleEmitterBar::SHARED_PTR barEmitter1 = std::make_shared<ParticleEmitterBar>(bar1P1, bar1P2, emitDir1, particleMinVel, particleMaxVel, ParticleProperties::ParticleType::GENERIC);
     barEmitter1->SetTransform(windowSpaceTransform);
     particleResetter->AddEmitter(barEmitter1);
 
-    //// bar on the right and emitting left
-    //glm::vec2 bar2P1 = glm::vec2(+0.8f, -0.3f);
-    //glm::vec2 bar2P2 = glm::vec2(+0.8f, +0.3f);
-    //glm::vec2 emitDir2 = glm::vec2(-1.0f, +0.0f);
-    //ParticleEmitterBar::SHARED_PTR barEmitter2 = std::make_shared<ParticleEmitterBar>(bar2P1, bar2P2, emitDir2, particleMinVel, particleMaxVel);
-    //barEmitter2->SetTransform(windowSpaceTransform);
-    //particleResetter->AddEmitter(barEmitter2);
+    // bar on the right and emitting left
+    // Note: A short bar of heavy particles so that the generic particles have something of a 
+    // different mass, size, and bounciness to run into.
+    glm::vec2 bar2P1 = glm::vec2(+0.8f, -0.3f);
+    glm::vec2 bar2P2 = glm::vec2(+0.8f, +0.3f);
+    glm::vec2 emitDir2 = glm::vec2(-1.0f, +0.0f);
+    ParticleEmitterBar::SHARED_PTR barEmitter2 = std::make_shared<ParticleEmitterBar>(bar2P1, bar2P2, emitDir2, particleMinVel, particleMaxVel, ParticleProperties::ParticleType::HEAVY);
+    barEmitter2->SetTransform(windowSpaceTransform);
+    particleResetter->AddEmitter(barEmitter2);
+}
+
+/*------------------------------------------------------------------------------------------------
+Description:
+    Generates and assigns the force fields (gravity, drag, attractors, etc.) that the 
+    ParticleUpdate compute controller applies to every particle.  There are none by default so 
+    that the particles fly straight and bounce without losing speed.
+
+    Note: These are accelerations (see ParticleForceFields.comp), so they don't depend on the 
+    particles' mass.
+Parameters: None
+Returns:    None
+Creator:    John Cox, 10/2017
+------------------------------------------------------------------------------------------------*/
+void GenerateParticleForceFields()
+{
+#if DEMO_SCENE == DEMO_SCENE_SETTLING_PACK
+    // pull everything down into a pile and bleed off the speed so that it settles
+    particleUpdater->AddForceField(ParticleForceField::Gravity(glm::vec4(0.0f, -0.5f, 0.0f, 0.0f)));
+    particleUpdater->AddForceField(ParticleForceField::Drag(0.5f, 0.5f));
+#endif
+
+    //// gravity
+    //particleUpdater->AddForceField(ParticleForceField::Gravity(glm::vec4(0.0f, -0.5f, 0.0f, 0.0f)));
+
+    //// air resistance
+    //particleUpdater->AddForceField(ParticleForceField::Drag(0.1f, 0.5f));
+
+    //// an attractor in the middle and a repulsor off to the right
+    //particleUpdater->AddForceField(ParticleForceField::Radial(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), 2.0f, 0.3f));
+    //particleUpdater->AddForceField(ParticleForceField::Radial(glm::vec4(0.5f, 0.2f, 0.0f, 1.0f), -4.0f, 0.15f));
 }
 
 #include "Include/Buffers/BvhNode.h"
@@ -248,7 +283,7 @@ void Init()
     particleBuffer = std::make_shared<ParticleSsbo>(MAX_PARTICLE_COUNT);
     
     // mass, collision radius, etc.
-    particlePropertiesBuffer = std::make_shared<ParticlePropertiesSsbo>();
+    particlePropertiesUbo = std::make_shared<ParticlePropertiesUbo>();
 
     // for resetting particles
     // Note: Put the bar emitters across from each and spraying particles toward each other and 
@@ -257,15 +292,16 @@ void Init()
     GenerateParticleEmitters();
 
     // for moving particles
-    particleUpdater = std::make_shared<ShaderControllers::ParticleUpdate>(particleBuffer);
+    particleUpdater = std::make_shared<ShaderControllers::ParticleUpdate>(particleBuffer, particlePropertiesUbo);
+    GenerateParticleForceFields();
 
     // for sorting, detecting collisions between, and resolving said collisions between particles
-    particleCollisions = std::make_shared<ShaderControllers::ParticleParticleCollisions>(particleBuffer, particlePropertiesBuffer);
+    particleCollisions = std::make_shared<ShaderControllers::ParticleParticleCollisions>(particleBuffer, particlePropertiesUbo);
 
     // for drawing particles
     particleRenderer = std::make_shared<ShaderControllers::RenderParticles>();
 
-    particleGeometryCollisions = std::make_shared<ShaderControllers::ParticlePolygonCollisions>("Blender3DStuff/airfoil.obj", particleBuffer);
+    particleGeometryCollisions = std::make_shared<ShaderControllers::ParticlePolygonCollisions>("Blender3DStuff/airfoil.obj", particleBuffer, particlePropertiesUbo);
 
     // for drawing non-particle things
     geometryRenderer = std::make_shared<ShaderControllers::RenderGeometry>();
@@ -289,16 +325,48 @@ void UpdateAllTheThings()
     using namespace std::chrono;
     steady_clock::time_point start = high_resolution_clock::now();
     
-    // just hard-code it for this demo
-    float deltaTimeSec = 0.01f;
+    // every frame simulates the same amount of time, but it may be split into sub-steps if 
+    // anything is moving fast enough to need it (see SubStepping.comp)
+    // Note: The large-step scenes (see DemoScene.comp) take one step of several times this 
+    // every frame to see if the XPBD solver (see ParticleSolver.comp) really does stay stable.
+#if DEMO_SCENE == DEMO_SCENE_LARGE_STEP_XPBD || DEMO_SCENE == DEMO_SCENE_LARGE_STEP_CCD
+    float frameTimeSec = DEMO_LARGE_STEP_FRAME_TIME_SEC;
+#else
+    float frameTimeSec = 0.01f;
+#endif
 
+    // Note: The sub-step count has to cover this frame's new particles too, and the GPU's 
+    // measurement of them won't be back for a frame (see ParticleUpdate::ChooseNumSubSteps(...)).
+    float maxEmissionSpeed = 0.0f;
+#if DEMO_SCENE == DEMO_SCENE_SETTLING_PACK
+    // stop emitting after a while so that the particles can settle (see DemoScene.comp)
+    static unsigned int frameCount = 0;
+    if (frameCount < DEMO_SETTLING_PACK_EMIT_FRAMES)
+    {
+        particleResetter->ResetParticles(40);
+        maxEmissionSpeed = particleResetter->MaxEmissionSpeed();
+        frameCount++;
+    }
+#else
     particleResetter->ResetParticles(40);
-    particleUpdater->Update(deltaTimeSec);
+    maxEmissionSpeed = particleResetter->MaxEmissionSpeed();
+#endif
+    unsigned int numSubSteps = particleUpdater->ChooseNumSubSteps(frameTimeSec, maxEmissionSpeed);
+    float deltaTimeSec = frameTimeSec / numSubSteps;
 
     bool withProfiling = false;
     bool generateGeometry = false;
-    particleCollisions->DetectAndResolve(withProfiling, generateGeometry);
-    particleGeometryCollisions->DetectAndResolve(withProfiling);
+    for (unsigned int subStep = 0; subStep < numSubSteps; subStep++)
+    {
+        particleUpdater->Update(deltaTimeSec);
+        particleCollisions->DetectAndResolve(deltaTimeSec, withProfiling, generateGeometry);
+        particleGeometryCollisions->DetectAndResolve(withProfiling);
+
+#if PARTICLE_SOLVER == PARTICLE_SOLVER_XPBD
+        // the collisions moved the particles, and now the velocities have to catch up
+        particleUpdater->DeriveVelocities(deltaTimeSec);
+#endif
+    }
 
 
     ShaderControllers::WaitOnQueuedSynchronization();
@@ -359,6 +427,8 @@ void Display()
     static int elapsedFramesPerSecond = 0;
     static double elapsedTime = 0.0;
     static double frameRate = 0.0;
+    static unsigned int numRebuildDecisions = 0;
+    static unsigned int numRebuilds = 0;
     elapsedFramesPerSecond++;
     elapsedTime += gTimer.Lap();
     if (elapsedTime > 1.0f)
@@ -366,6 +436,9 @@ void Display()
         frameRate = (double)elapsedFramesPerSecond / elapsedTime;
         elapsedFramesPerSecond = 0;
         elapsedTime -= 1.0f;
+
+        // Note: This waits on the GPU, so it is only read once a second.
+        particleCollisions->ReadNeighbourListRebuildCounts(numRebuildDecisions, numRebuilds);
     }
     snprintf(str, FRAMERATE_STRING_SIZE, "%.2lf", frameRate);
 
@@ -379,10 +452,26 @@ void Display()
 
     // now show number of active particles
     // Note: For some reason, lower case "i" seems to appear too close to the other letters.
-    snprintf(str, FRAMERATE_STRING_SIZE, "active: %d", particleUpdater->NumActiveParticles());
+    snprintf(str, FRAMERATE_STRING_SIZE, "active: %u", particleUpdater->NumActiveParticles());
     float numActiveParticlesXY[2] = { -0.99f, +0.7f };
     gTextAtlases.GetAtlas(48)->RenderText(str, numActiveParticlesXY, scaleXY, color);
 
+    // and how many sub-steps the last frame needed
+    snprintf(str, FRAMERATE_STRING_SIZE, "sub-steps: %u", particleUpdater->NumSubSteps());
+    float numSubStepsXY[2] = { -0.99f, +0.6f };
+    gTextAtlases.GetAtlas(48)->RenderText(str, numSubStepsXY, scaleXY, color);
+
+    // and how many of the sub-steps needed to rebuild the BVH (see NeighbourListSkin.comp)
+    snprintf(str, FRAMERATE_STRING_SIZE, "rebuilds: %u/%u", numRebuilds, numRebuildDecisions);
+    float numRebuildsXY[2] = { -0.99f, +0.5f };
+    gTextAtlases.GetAtlas(48)->RenderText(str, numRebuildsXY, scaleXY, color);
+
+    // and how fast the fastest particle is going, in its own radii per second (see 
+    // SubStepping.comp)
+    snprintf(str, FRAMERATE_STRING_SIZE, "max speed: %.0f", particleUpdater->MaxSpeedInRadii());
+    float maxSpeedXY[2] = { -0.99f, +0.4f };
+    gTextAtlases.GetAtlas(48)->RenderText(str, maxSpeedXY, scaleXY, color);
+
 
     // clean up bindings
     glUseProgram(0);